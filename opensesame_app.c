@@ -12,9 +12,18 @@
 #include <gui/view.h>
 #include <gui/modules/submenu.h>
 #include <gui/modules/widget.h>
+#include <gui/modules/variable_item_list.h>
 #include <input/input.h>
 #include <furi_hal_subghz.h>
+#include <notification/notification_messages.h>
+#include <lib/subghz/devices/devices.h>
+#include <lib/drivers/cc1101.h>
 #include <storage/storage.h>
+#include <toolbox/stream/file_stream.h>
+#include <flipper_format/flipper_format.h>
+#include <cli/cli.h>
+#include <toolbox/args.h>
+#include <toolbox/version.h>
 #include <string.h>
 #include <stdlib.h>
 #include <math.h>
@@ -22,7 +31,87 @@
 // --- Constants ---
 #define CODE_BUFFER_SIZE 320 // Approx 10-sec rolling buffer
 #define WORKER_EVENT_STOP (1 << 0)
-#define PAYLOADS_PER_CHUNK 16
+#define STOP_LATENCY_BOUND_MS 50 // Longest the worker runs between cancellation points
+#define STOP_CHECK_DIGITS 1024 // Sequence digits scanned between cancellation points
+#define STOP_BENCH_TRIALS_MAX 16
+#define STOP_BENCH_PHASE_WAIT_MS 5000 // For a run to reach the phase asked for
+#define PAYLOADS_PER_CHUNK 16 // Until the auto-tuner picks a chunk airtime
+#define PRIOR_CODES_MAX 64
+#define BIT_PERIOD_US 650
+#define BIT_PERIOD_VARIANTS_MAX 5
+#define JITTER_BUCKET_COUNT 7
+#define TX_POLL_SPIN_US 2000 // Poll finely for TX completion this close to the end
+#define CLOCK_VIRTUAL_SLEEP_EVERY 1024 // Virtual waits between real 1-tick sleeps
+#define CHUNK_BUFFER_SIZE 256 // PAYLOADS_PER_CHUNK payloads of up to 16 bytes
+#define PLAN_MAX_STEPS 80
+#define RADIO_MAX 2
+#define RADIO_EXTERNAL_DEVICE_NAME "cc1101_ext"
+#define CC1101_XOSC_HZ 26000000ULL
+#define CC1101_FIFO_BYTES 64
+#define CC1101_FIFO_THRESHOLD 33 // TX FIFO bytes at FIFOTHR = 7
+#define CC1101_PACKET_MAX 255 // Longest fixed-length packet
+#define CHUNK_BYTES_MAX CC1101_PACKET_MAX // One fixed-length FIFO packet
+#define FIFO_EVENT_REFILL (1 << 1)
+#define FIFO_MODEL_LATENCY_US 200 // Simulated threshold interrupt to refill
+#define SEQUENCE_CACHE_SLOTS 6
+#define SEQUENCE_CACHE_BUDGET 16384 // Packed bytes kept across retries
+#define SEQUENCE_CACHE_MIN_FREE_HEAP 12288 // Evict rather than go below this
+#define PREFETCH_QUEUE_DEPTH 2 // Plan targets queued for sequence generation
+#define PREFETCH_KEY(k, n) (((uint16_t)(k) << 8) | (n))
+#define PREFETCH_STOP UINT8_MAX // Queued to wake the prefetch thread for a stop
+#define EVENT_LOG_RECORDS 256 // Power of two
+#define EVENT_LOG_FLUSH_MS 100
+#define EVENT_LOG_PATH APP_DATA_PATH("session.evl")
+#define EVENT_LOG_MAGIC 0x474C534FUL // "OSLG"
+#define EVENT_LOG_VERSION 1
+#define TRACE_PATH APP_DATA_PATH("trace.json")
+#define TRACE_WRITE_BYTES 1024 // JSON buffered before each SD write
+#define LONG_RUN_SAMPLE_MS 1000 // Battery current sampling
+#define LONG_RUN_FORECAST_MS 10000
+#define LONG_RUN_RESERVE_PERMILLE 50 // Charge the forecast keeps back
+#define LONG_RUN_SLEEP_MIN_MS 20 // Shorter idle keeps the radio awake
+#define PACKED_SEQUENCE_BYTES(digits) (((digits) + 3) / 4)
+#define DIGIT_RADIX_MAX 4 // Packed sequences store 2 bits per digit
+#define CODE_DIGITS_MAX 32
+#define STREAM_ROTATE_CODES_MAX 65536 // Larger streamed sequences start at digit 0
+#define PACK_DIR APP_DATA_PATH("packs")
+#define PACK_PATH_FORMAT APP_DATA_PATH("packs/debruijn_%u_%u.osp")
+#define PACK_PATH_SIZE 64
+#define PACK_MAGIC 0x4B50534FUL // "OSPK"
+#define PACK_VERSION 2
+#define PACK_BLOCK_DIGITS 1024 // Digits covered by each block CRC
+#define PACK_BLOCK_BYTES PACKED_SEQUENCE_BYTES(PACK_BLOCK_DIGITS) // Largest block, k = 4
+#define PRIOR_CODES_PATH APP_DATA_PATH("priors.txt")
+#define HISTORY_PATH APP_DATA_PATH("history.osh")
+#define HISTORY_INDEX_PATH APP_DATA_PATH("history.idx")
+#define HISTORY_MAGIC 0x484C534FUL // "OSLH"
+#define HISTORY_INDEX_MAGIC 0x494C534FUL // "OSLI"
+#define HISTORY_VERSION 1
+#define HISTORY_HITS_MAX 4 // Newest recorded hits kept per target and mode
+#define HISTORY_AGGREGATES_MAX 256
+#define HISTORY_READ_RECORDS 16
+#define HISTORY_MIN_SAMPLE_MS 10000 // Measured airtime before the estimator trusts it
+#define REPORT_OVERHEAD_FLAG_PERMILLE 500 // Step overhead per unit of airtime that gets flagged
+#define JOB_QUEUE_MAX 16
+#define JOB_QUEUE_PATH APP_DATA_PATH("queue.txt")
+#define JOB_QUEUE_FILETYPE "OpenSesame Job Queue"
+#define JOB_QUEUE_VERSION 1
+#define TUNING_PATH_FORMAT APP_DATA_PATH("tuning_%s.txt") // Per device name
+#define TUNING_PATH_SIZE 64
+#define TUNING_FILETYPE "OpenSesame Tuning"
+#define TUNING_VERSION 1
+#define TUNING_SAMPLES 8 // Transmissions timed per chunk length
+#define TUNING_SHORT_DIGITS 4
+#define TUNING_LONG_DIGITS 64
+#define TUNING_GENERATE_DIGITS 16384
+#define TUNING_OVERHEAD_PERMILLE 20 // Setup and gap time allowed per unit of airtime
+#define TUNING_CHUNK_AIRTIME_MIN_MS 20
+#define TUNING_CHUNK_AIRTIME_MAX_MS 500 // Pause and two-radio interleave granularity
+#define TUNING_TARGET_GAP_MIN_MS 20 // A clear break between two targets' formats
+#define TUNING_YIELD_DIGITS_MIN 256
+#define TUNING_YIELD_DIGITS_MAX 65536
+#define CLI_COMMAND "opensesame"
+#define CLI_CODES_DEFAULT 16
 
 // --- Attack Mode Definitions ---
 typedef enum {
@@ -51,66 +140,85 @@ const char* attack_mode_desc[] = {
 typedef struct {
     const char* name;
     uint32_t frequency;
-    uint8_t bits;
-    uint8_t length;
-    bool trinary;
+    uint8_t bits; // Digits per code
+    uint8_t length; // Bits per digit pattern
+    uint8_t radix; // Symbols per digit, 2 to DIGIT_RADIX_MAX
     const char* encoding_desc;
     uint32_t b0;
     uint32_t b1;
     uint32_t b2;
+    uint32_t b3;
+    uint32_t binary_mask; // Mixed radix: digits limited to 0/1, first-sent digit = bit 0
+    const int32_t* freq_offsets; // Optional drift sweep, Hz from nominal
+    uint8_t freq_offset_count;
 } OpenSesameTarget;
 
+// Symbol-rate sweep, shortest bit period first so the fastest variant
+// covers the keyspace soonest. Must stay sorted ascending.
+static const uint16_t opensesame_bit_periods_us[BIT_PERIOD_VARIANTS_MAX] = {400, 500, 650, 800, 1000};
+
+// Receivers with aged crystals drift by tens of kHz
+static const int32_t opensesame_drift_offsets[] = {25000, -25000, 50000, -50000};
+
 const OpenSesameTarget opensesame_targets[] = {
     {
         .name = "Stanley/Linear 310M",
         .frequency = 310000000,
         .bits = 10,
         .length = 4,
-        .trinary = false,
+        .radix = 2,
         .encoding_desc = "Binary 10-bit",
         .b0 = 0x8,
         .b1 = 0xe,
         .b2 = 0x0,
+        .freq_offsets = opensesame_drift_offsets,
+        .freq_offset_count = COUNT_OF(opensesame_drift_offsets),
     },
     {
         .name = "MegaCode 318M",
         .frequency = 318000000,
         .bits = 8,
         .length = 4,
-        .trinary = true,
+        .radix = 3,
         .encoding_desc = "Trinary 8-bit",
         .b0 = 0x020100,
         .b1 = 0x03fd00,
         .b2 = 0x03fdfe,
+        .freq_offsets = opensesame_drift_offsets,
+        .freq_offset_count = COUNT_OF(opensesame_drift_offsets),
     },
     {
         .name = "Chamberlain 390M",
         .frequency = 390000000,
         .bits = 9,
         .length = 4,
-        .trinary = false,
+        .radix = 2,
         .encoding_desc = "Binary 9-bit",
         .b0 = 0x8,
         .b1 = 0xe,
         .b2 = 0x0,
+        .freq_offsets = opensesame_drift_offsets,
+        .freq_offset_count = COUNT_OF(opensesame_drift_offsets),
     },
     {
         .name = "Chamberlain 315M",
         .frequency = 315000000,
         .bits = 9,
         .length = 4,
-        .trinary = false,
+        .radix = 2,
         .encoding_desc = "Binary 9-bit",
         .b0 = 0x8,
         .b1 = 0xe,
         .b2 = 0x0,
+        .freq_offsets = opensesame_drift_offsets,
+        .freq_offset_count = COUNT_OF(opensesame_drift_offsets),
     },
     {
         .name = "All Known Models",
         .frequency = 310000000, // Default freq, will be overridden
         .bits = 10, // Default bits, will be overridden
         .length = 4,
-        .trinary = false,
+        .radix = 2,
         .encoding_desc = "Cycles known 4 targets",
         .b0 = 0x8,
         .b1 = 0xe,
@@ -121,7 +229,7 @@ const OpenSesameTarget opensesame_targets[] = {
         .frequency = 310000000, // Default freq, will be overridden
         .bits = 10, // Default bits, will be overridden
         .length = 4,
-        .trinary = false,
+        .radix = 2,
         .encoding_desc = "All Known + Generic Brute",
         .b0 = 0x8,
         .b1 = 0xe,
@@ -132,7 +240,7 @@ const OpenSesameTarget opensesame_targets[] = {
         .frequency = 433920000, // Default freq, will be overridden
         .bits = 10, // Default bits, will be overridden
         .length = 4,
-        .trinary = false,
+        .radix = 2,
         .encoding_desc = "Targets 433/868 MHz",
         .b0 = 0x8,
         .b1 = 0xe,
@@ -142,409 +250,409 @@ const OpenSesameTarget opensesame_targets[] = {
     {
         .name = "Internal Brute 300M 10b",
         .frequency = 300000000,
-        .bits = 10, .length = 4, .trinary = false,
+        .bits = 10, .length = 4, .radix = 2,
         .encoding_desc = "Internal", .b0 = 0x8, .b1 = 0xe, .b2 = 0x0,
     },
     {
         .name = "Internal Brute 315M 8b",
         .frequency = 315000000,
-        .bits = 8, .length = 4, .trinary = false,
+        .bits = 8, .length = 4, .radix = 2,
         .encoding_desc = "Internal", .b0 = 0x8, .b1 = 0xe, .b2 = 0x0,
     },
     {
         .name = "Internal Brute 390M 8b",
         .frequency = 390000000,
-        .bits = 8, .length = 4, .trinary = false,
+        .bits = 8, .length = 4, .radix = 2,
         .encoding_desc = "Internal", .b0 = 0x8, .b1 = 0xe, .b2 = 0x0,
     },
     {
         .name = "Internal Brute 390M 10b",
         .frequency = 390000000,
-        .bits = 10, .length = 4, .trinary = false,
+        .bits = 10, .length = 4, .radix = 2,
         .encoding_desc = "Internal", .b0 = 0x8, .b1 = 0xe, .b2 = 0x0,
     },
     {
         .name = "Internal Brute 315M 10b",
         .frequency = 315000000,
-        .bits = 10, .length = 4, .trinary = false,
+        .bits = 10, .length = 4, .radix = 2,
         .encoding_desc = "Internal", .b0 = 0x8, .b1 = 0xe, .b2 = 0x0,
     },
     {
         .name = "Internal Brute 310M 8b",
         .frequency = 310000000,
-        .bits = 8, .length = 4, .trinary = false,
+        .bits = 8, .length = 4, .radix = 2,
         .encoding_desc = "Internal", .b0 = 0x8, .b1 = 0xe, .b2 = 0x0,
     },
     {
         .name = "Internal Brute 300M 8b",
         .frequency = 300000000,
-        .bits = 8, .length = 4, .trinary = false,
+        .bits = 8, .length = 4, .radix = 2,
         .encoding_desc = "Internal", .b0 = 0x8, .b1 = 0xe, .b2 = 0x0,
     },
     {
         .name = "Internal Brute 315M 12b",
         .frequency = 315000000,
-        .bits = 12, .length = 4, .trinary = false,
+        .bits = 12, .length = 4, .radix = 2,
         .encoding_desc = "Internal", .b0 = 0x8, .b1 = 0xe, .b2 = 0x0,
     },
     {
         .name = "Internal Brute 390M 12b",
         .frequency = 390000000,
-        .bits = 12, .length = 4, .trinary = false,
+        .bits = 12, .length = 4, .radix = 2,
         .encoding_desc = "Internal", .b0 = 0x8, .b1 = 0xe, .b2 = 0x0,
     },
     {
         .name = "Internal Brute 310M 12b",
         .frequency = 310000000,
-        .bits = 12, .length = 4, .trinary = false,
+        .bits = 12, .length = 4, .radix = 2,
         .encoding_desc = "Internal", .b0 = 0x8, .b1 = 0xe, .b2 = 0x0,
     },
     {
         .name = "Internal Brute 300M 12b",
         .frequency = 300000000,
-        .bits = 12, .length = 4, .trinary = false,
+        .bits = 12, .length = 4, .radix = 2,
         .encoding_desc = "Internal", .b0 = 0x8, .b1 = 0xe, .b2 = 0x0,
     },
     {
         .name = "Internal Brute 318M 8b Bin",
         .frequency = 318000000,
-        .bits = 8, .length = 4, .trinary = false, // Binary, not trinary
+        .bits = 8, .length = 4, .radix = 2, // Binary, not trinary
         .encoding_desc = "Internal", .b0 = 0x8, .b1 = 0xe, .b2 = 0x0,
     },
     {
         .name = "Internal Brute 318M 10b",
         .frequency = 318000000,
-        .bits = 10, .length = 4, .trinary = false,
+        .bits = 10, .length = 4, .radix = 2,
         .encoding_desc = "Internal", .b0 = 0x8, .b1 = 0xe, .b2 = 0x0,
     },
     {
         .name = "Internal Brute 318M 12b",
         .frequency = 318000000,
-        .bits = 12, .length = 4, .trinary = false,
+        .bits = 12, .length = 4, .radix = 2,
         .encoding_desc = "Internal", .b0 = 0x8, .b1 = 0xe, .b2 = 0x0,
     },
     {
         .name = "Internal Brute 303M 8b",
         .frequency = 303875000,
-        .bits = 8, .length = 4, .trinary = false,
+        .bits = 8, .length = 4, .radix = 2,
         .encoding_desc = "Internal", .b0 = 0x8, .b1 = 0xe, .b2 = 0x0,
     },
     {
         .name = "Internal Brute 303M 10b",
         .frequency = 303875000,
-        .bits = 10, .length = 4, .trinary = false,
+        .bits = 10, .length = 4, .radix = 2,
         .encoding_desc = "Internal", .b0 = 0x8, .b1 = 0xe, .b2 = 0x0,
     },
     {
         .name = "Internal Brute 433M 8b",
         .frequency = 433920000,
-        .bits = 8, .length = 4, .trinary = false,
+        .bits = 8, .length = 4, .radix = 2,
         .encoding_desc = "Internal", .b0 = 0x8, .b1 = 0xe, .b2 = 0x0,
     },
     {
         .name = "Internal Brute 433M 10b",
         .frequency = 433920000,
-        .bits = 10, .length = 4, .trinary = false,
+        .bits = 10, .length = 4, .radix = 2,
         .encoding_desc = "Internal", .b0 = 0x8, .b1 = 0xe, .b2 = 0x0,
     },
     {
         .name = "Internal Brute 303M 12b",
         .frequency = 303875000,
-        .bits = 12, .length = 4, .trinary = false,
+        .bits = 12, .length = 4, .radix = 2,
         .encoding_desc = "Internal", .b0 = 0x8, .b1 = 0xe, .b2 = 0x0,
     },
     {
         .name = "Internal Brute 433M 12b",
         .frequency = 433920000,
-        .bits = 12, .length = 4, .trinary = false,
+        .bits = 12, .length = 4, .radix = 2,
         .encoding_desc = "Internal", .b0 = 0x8, .b1 = 0xe, .b2 = 0x0,
     },
     {
         .name = "Internal Brute 310M 9b",
         .frequency = 310000000,
-        .bits = 9, .length = 4, .trinary = false,
+        .bits = 9, .length = 4, .radix = 2,
         .encoding_desc = "Internal", .b0 = 0x8, .b1 = 0xe, .b2 = 0x0,
     },
     {
         .name = "Internal Brute 300M 9b",
         .frequency = 300000000,
-        .bits = 9, .length = 4, .trinary = false,
+        .bits = 9, .length = 4, .radix = 2,
         .encoding_desc = "Internal", .b0 = 0x8, .b1 = 0xe, .b2 = 0x0,
     },
     {
         .name = "Internal Brute 318M 9b",
         .frequency = 318000000,
-        .bits = 9, .length = 4, .trinary = false,
+        .bits = 9, .length = 4, .radix = 2,
         .encoding_desc = "Internal", .b0 = 0x8, .b1 = 0xe, .b2 = 0x0,
     },
     {
         .name = "Internal Brute 303M 9b",
         .frequency = 303875000,
-        .bits = 9, .length = 4, .trinary = false,
+        .bits = 9, .length = 4, .radix = 2,
         .encoding_desc = "Internal", .b0 = 0x8, .b1 = 0xe, .b2 = 0x0,
     },
     {
         .name = "Internal Brute 433M 9b",
         .frequency = 433920000,
-        .bits = 9, .length = 4, .trinary = false,
+        .bits = 9, .length = 4, .radix = 2,
         .encoding_desc = "Internal", .b0 = 0x8, .b1 = 0xe, .b2 = 0x0,
     },
     {
         .name = "Internal Brute 310M 11b",
         .frequency = 310000000,
-        .bits = 11, .length = 4, .trinary = false,
+        .bits = 11, .length = 4, .radix = 2,
         .encoding_desc = "Internal", .b0 = 0x8, .b1 = 0xe, .b2 = 0x0,
     },
     {
         .name = "Internal Brute 315M 11b",
         .frequency = 315000000,
-        .bits = 11, .length = 4, .trinary = false,
+        .bits = 11, .length = 4, .radix = 2,
         .encoding_desc = "Internal", .b0 = 0x8, .b1 = 0xe, .b2 = 0x0,
     },
     {
         .name = "Internal Brute 390M 11b",
         .frequency = 390000000,
-        .bits = 11, .length = 4, .trinary = false,
+        .bits = 11, .length = 4, .radix = 2,
         .encoding_desc = "Internal", .b0 = 0x8, .b1 = 0xe, .b2 = 0x0,
     },
     {
         .name = "Internal Brute 300M 11b",
         .frequency = 300000000,
-        .bits = 11, .length = 4, .trinary = false,
+        .bits = 11, .length = 4, .radix = 2,
         .encoding_desc = "Internal", .b0 = 0x8, .b1 = 0xe, .b2 = 0x0,
     },
     {
         .name = "Internal Brute 318M 11b",
         .frequency = 318000000,
-        .bits = 11, .length = 4, .trinary = false,
+        .bits = 11, .length = 4, .radix = 2,
         .encoding_desc = "Internal", .b0 = 0x8, .b1 = 0xe, .b2 = 0x0,
     },
     {
         .name = "Internal Brute 433M 11b",
         .frequency = 433920000,
-        .bits = 11, .length = 4, .trinary = false,
+        .bits = 11, .length = 4, .radix = 2,
         .encoding_desc = "Internal", .b0 = 0x8, .b1 = 0xe, .b2 = 0x0,
     },
     {
         .name = "Internal Brute 310M 14b",
         .frequency = 310000000,
-        .bits = 14, .length = 4, .trinary = false, // de Bruijn incompatible (n > 13)
+        .bits = 14, .length = 4, .radix = 2,
         .encoding_desc = "Internal", .b0 = 0x8, .b1 = 0xe, .b2 = 0x0,
     },
     {
         .name = "Internal Brute 315M 14b",
         .frequency = 315000000,
-        .bits = 14, .length = 4, .trinary = false, // de Bruijn incompatible (n > 13)
+        .bits = 14, .length = 4, .radix = 2,
         .encoding_desc = "Internal", .b0 = 0x8, .b1 = 0xe, .b2 = 0x0,
     },
     {
         .name = "Internal Brute 390M 14b",
         .frequency = 390000000,
-        .bits = 14, .length = 4, .trinary = false, // de Bruijn incompatible (n > 13)
+        .bits = 14, .length = 4, .radix = 2,
         .encoding_desc = "Internal", .b0 = 0x8, .b1 = 0xe, .b2 = 0x0,
     },
     {
         .name = "Internal Brute 300M 14b",
         .frequency = 300000000,
-        .bits = 14, .length = 4, .trinary = false, // de Bruijn incompatible (n > 13)
+        .bits = 14, .length = 4, .radix = 2,
         .encoding_desc = "Internal", .b0 = 0x8, .b1 = 0xe, .b2 = 0x0,
     },
     {
         .name = "Internal Brute 318M 14b",
         .frequency = 318000000,
-        .bits = 14, .length = 4, .trinary = false, // de Bruijn incompatible (n > 13)
+        .bits = 14, .length = 4, .radix = 2,
         .encoding_desc = "Internal", .b0 = 0x8, .b1 = 0xe, .b2 = 0x0,
     },
     {
         .name = "Internal Brute 433M 14b",
         .frequency = 433920000,
-        .bits = 14, .length = 4, .trinary = false, // de Bruijn incompatible (n > 13)
+        .bits = 14, .length = 4, .radix = 2,
         .encoding_desc = "Internal", .b0 = 0x8, .b1 = 0xe, .b2 = 0x0,
     },
     {
         .name = "Internal Brute 315M 9b Tri",
         .frequency = 315000000,
-        .bits = 9, .length = 4, .trinary = true, // de Bruijn incompatible (n > 8)
+        .bits = 9, .length = 4, .radix = 3,
         .encoding_desc = "Internal", .b0 = 0x020100, .b1 = 0x03fd00, .b2 = 0x03fdfe,
     },
     {
         .name = "Internal Brute 390M 9b Tri",
         .frequency = 390000000,
-        .bits = 9, .length = 4, .trinary = true, // de Bruijn incompatible (n > 8)
+        .bits = 9, .length = 4, .radix = 3,
         .encoding_desc = "Internal", .b0 = 0x020100, .b1 = 0x03fd00, .b2 = 0x03fdfe,
     },
     {
         .name = "Internal Brute 300M 13b",
         .frequency = 300000000,
-        .bits = 13, .length = 4, .trinary = false,
+        .bits = 13, .length = 4, .radix = 2,
         .encoding_desc = "Internal", .b0 = 0x8, .b1 = 0xe, .b2 = 0x0,
     },
     {
         .name = "Internal Brute 310M 13b",
         .frequency = 310000000,
-        .bits = 13, .length = 4, .trinary = false,
+        .bits = 13, .length = 4, .radix = 2,
         .encoding_desc = "Internal", .b0 = 0x8, .b1 = 0xe, .b2 = 0x0,
     },
     {
         .name = "Internal Brute 315M 13b",
         .frequency = 315000000,
-        .bits = 13, .length = 4, .trinary = false,
+        .bits = 13, .length = 4, .radix = 2,
         .encoding_desc = "Internal", .b0 = 0x8, .b1 = 0xe, .b2 = 0x0,
     },
     {
         .name = "Internal Brute 318M 13b",
         .frequency = 318000000,
-        .bits = 13, .length = 4, .trinary = false,
+        .bits = 13, .length = 4, .radix = 2,
         .encoding_desc = "Internal", .b0 = 0x8, .b1 = 0xe, .b2 = 0x0,
     },
     {
         .name = "Internal Brute 390M 13b",
         .frequency = 390000000,
-        .bits = 13, .length = 4, .trinary = false,
+        .bits = 13, .length = 4, .radix = 2,
         .encoding_desc = "Internal", .b0 = 0x8, .b1 = 0xe, .b2 = 0x0,
     },
     {
         .name = "Internal Brute 433M 13b",
         .frequency = 433920000,
-        .bits = 13, .length = 4, .trinary = false,
+        .bits = 13, .length = 4, .radix = 2,
         .encoding_desc = "Internal", .b0 = 0x8, .b1 = 0xe, .b2 = 0x0,
     },
     {
         .name = "Internal Brute 303M 11b",
         .frequency = 303875000,
-        .bits = 11, .length = 4, .trinary = false,
+        .bits = 11, .length = 4, .radix = 2,
         .encoding_desc = "Internal", .b0 = 0x8, .b1 = 0xe, .b2 = 0x0,
     },
     {
         .name = "Internal Brute 303M 14b",
         .frequency = 303875000,
-        .bits = 14, .length = 4, .trinary = false, // de Bruijn incompatible (n > 13)
+        .bits = 14, .length = 4, .radix = 2,
         .encoding_desc = "Internal", .b0 = 0x8, .b1 = 0xe, .b2 = 0x0,
     },
     {
         .name = "Internal Brute 868M 8b",
         .frequency = 868350000,
-        .bits = 8, .length = 4, .trinary = false,
+        .bits = 8, .length = 4, .radix = 2,
         .encoding_desc = "Internal", .b0 = 0x8, .b1 = 0xe, .b2 = 0x0,
     },
     {
         .name = "Internal Brute 868M 9b",
         .frequency = 868350000,
-        .bits = 9, .length = 4, .trinary = false,
+        .bits = 9, .length = 4, .radix = 2,
         .encoding_desc = "Internal", .b0 = 0x8, .b1 = 0xe, .b2 = 0x0,
     },
     {
         .name = "Internal Brute 868M 10b",
         .frequency = 868350000,
-        .bits = 10, .length = 4, .trinary = false,
+        .bits = 10, .length = 4, .radix = 2,
         .encoding_desc = "Internal", .b0 = 0x8, .b1 = 0xe, .b2 = 0x0,
     },
     {
         .name = "Internal Brute 868M 11b",
         .frequency = 868350000,
-        .bits = 11, .length = 4, .trinary = false,
+        .bits = 11, .length = 4, .radix = 2,
         .encoding_desc = "Internal", .b0 = 0x8, .b1 = 0xe, .b2 = 0x0,
     },
     {
         .name = "Internal Brute 868M 12b",
         .frequency = 868350000,
-        .bits = 12, .length = 4, .trinary = false,
+        .bits = 12, .length = 4, .radix = 2,
         .encoding_desc = "Internal", .b0 = 0x8, .b1 = 0xe, .b2 = 0x0,
     },
     {
         .name = "Internal Brute 868M 13b",
         .frequency = 868350000,
-        .bits = 13, .length = 4, .trinary = false,
+        .bits = 13, .length = 4, .radix = 2,
         .encoding_desc = "Internal", .b0 = 0x8, .b1 = 0xe, .b2 = 0x0,
     },
     {
         .name = "Internal Brute 868M 14b",
         .frequency = 868350000,
-        .bits = 14, .length = 4, .trinary = false, // de Bruijn incompatible (n > 13)
+        .bits = 14, .length = 4, .radix = 2,
         .encoding_desc = "Internal", .b0 = 0x8, .b1 = 0xe, .b2 = 0x0,
     },
     {
         .name = "Internal Euro 433M 8b",
         .frequency = 433920000,
-        .bits = 8, .length = 4, .trinary = false,
+        .bits = 8, .length = 4, .radix = 2,
         .encoding_desc = "Internal", .b0 = 0x8, .b1 = 0xe, .b2 = 0x0,
     },
     {
         .name = "Internal Euro 433M 9b",
         .frequency = 433920000,
-        .bits = 9, .length = 4, .trinary = false,
+        .bits = 9, .length = 4, .radix = 2,
         .encoding_desc = "Internal", .b0 = 0x8, .b1 = 0xe, .b2 = 0x0,
     },
     {
         .name = "Internal Euro 433M 10b",
         .frequency = 433920000,
-        .bits = 10, .length = 4, .trinary = false,
+        .bits = 10, .length = 4, .radix = 2,
         .encoding_desc = "Internal", .b0 = 0x8, .b1 = 0xe, .b2 = 0x0,
     },
     {
         .name = "Internal Euro 433M 11b",
         .frequency = 433920000,
-        .bits = 11, .length = 4, .trinary = false,
+        .bits = 11, .length = 4, .radix = 2,
         .encoding_desc = "Internal", .b0 = 0x8, .b1 = 0xe, .b2 = 0x0,
     },
     {
         .name = "Internal Euro 433M 12b",
         .frequency = 433920000,
-        .bits = 12, .length = 4, .trinary = false,
+        .bits = 12, .length = 4, .radix = 2,
         .encoding_desc = "Internal", .b0 = 0x8, .b1 = 0xe, .b2 = 0x0,
     },
     {
         .name = "Internal Euro 433M 13b",
         .frequency = 433920000,
-        .bits = 13, .length = 4, .trinary = false,
+        .bits = 13, .length = 4, .radix = 2,
         .encoding_desc = "Internal", .b0 = 0x8, .b1 = 0xe, .b2 = 0x0,
     },
     {
         .name = "Internal Euro 433M 14b",
         .frequency = 433920000,
-        .bits = 14, .length = 4, .trinary = false, // de Bruijn incompatible (n > 13)
+        .bits = 14, .length = 4, .radix = 2,
         .encoding_desc = "Internal", .b0 = 0x8, .b1 = 0xe, .b2 = 0x0,
     },
     {
         .name = "Internal Euro 868M 8b",
         .frequency = 868350000,
-        .bits = 8, .length = 4, .trinary = false,
+        .bits = 8, .length = 4, .radix = 2,
         .encoding_desc = "Internal", .b0 = 0x8, .b1 = 0xe, .b2 = 0x0,
     },
     {
         .name = "Internal Euro 868M 9b",
         .frequency = 868350000,
-        .bits = 9, .length = 4, .trinary = false,
+        .bits = 9, .length = 4, .radix = 2,
         .encoding_desc = "Internal", .b0 = 0x8, .b1 = 0xe, .b2 = 0x0,
     },
     {
         .name = "Internal Euro 868M 10b",
         .frequency = 868350000,
-        .bits = 10, .length = 4, .trinary = false,
+        .bits = 10, .length = 4, .radix = 2,
         .encoding_desc = "Internal", .b0 = 0x8, .b1 = 0xe, .b2 = 0x0,
     },
     {
         .name = "Internal Euro 868M 11b",
         .frequency = 868350000,
-        .bits = 11, .length = 4, .trinary = false,
+        .bits = 11, .length = 4, .radix = 2,
         .encoding_desc = "Internal", .b0 = 0x8, .b1 = 0xe, .b2 = 0x0,
     },
     {
         .name = "Internal Euro 868M 12b",
         .frequency = 868350000,
-        .bits = 12, .length = 4, .trinary = false,
+        .bits = 12, .length = 4, .radix = 2,
         .encoding_desc = "Internal", .b0 = 0x8, .b1 = 0xe, .b2 = 0x0,
     },
     {
         .name = "Internal Euro 868M 13b",
         .frequency = 868350000,
-        .bits = 13, .length = 4, .trinary = false,
+        .bits = 13, .length = 4, .radix = 2,
         .encoding_desc = "Internal", .b0 = 0x8, .b1 = 0xe, .b2 = 0x0,
     },
     {
         .name = "Internal Euro 868M 14b",
         .frequency = 868350000,
-        .bits = 14, .length = 4, .trinary = false, // de Bruijn incompatible (n > 13)
+        .bits = 14, .length = 4, .radix = 2,
         .encoding_desc = "Internal", .b0 = 0x8, .b1 = 0xe, .b2 = 0x0,
     },
 };
@@ -557,6 +665,61 @@ static const uint8_t opensesame_ook_preset_data[] __attribute__((aligned(4))) =
     0x02, 0x0D, 0x03, 0x07, 0x08, 0x32, 0x0B, 0x06, 0x15, 0x40, 0x00, 0x00,
     0x00, 0x00, 0x00, 0x00, 0x00, 0x00};
 
+// --- FIFO Preset ---
+// Packet-mode OOK: GDO0 follows the TX FIFO threshold, no preamble, sync
+// word or CRC, fixed length. The data rate and length are set per chunk.
+static const uint8_t opensesame_fifo_preset_data[] __attribute__((aligned(4))) = {
+    0x02, 0x02, // IOCFG0: TX FIFO at or above threshold
+    0x03, 0x07, // FIFOTHR: 33 bytes
+    0x07, 0x00, // PKTCTRL1: no address check or status bytes
+    0x08, 0x00, // PKTCTRL0: FIFO data, fixed length
+    0x0B, 0x06, // FSCTRL1
+    0x12, 0x30, // MDMCFG2: ASK/OOK, no preamble or sync word
+    0x15, 0x40, // DEVIATN
+    0x17, 0x00, // MCSM1: idle after the packet
+    0x22, 0x11, // FREND0: OOK '1' at PATABLE[1], '0' at PATABLE[0]
+    0x00, 0x00,
+    0x00, 0xC0, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00};
+
+// --- Duty-Cycle Bands ---
+// ETSI EN 300 220 sub-bands used by the European targets. Duty cycle is
+// assessed over any one hour, so each band keeps the airtime charged in
+// each of the last DUTY_SLOTS minutes. Any one-hour window lies within
+// them, so holding their sum to the hour's allowance holds every window.
+#define DUTY_BAND_NONE 0xFF
+#define DUTY_WINDOW_MS (60 * 60 * 1000)
+#define DUTY_SLOT_MS (60 * 1000)
+#define DUTY_SLOTS (DUTY_WINDOW_MS / DUTY_SLOT_MS + 1) // The current minute and the hour before
+
+typedef struct {
+    const char* name;
+    uint32_t freq_min;
+    uint32_t freq_max;
+    uint16_t duty_permille;
+} DutyBand;
+
+static const DutyBand duty_bands[] = {
+    {.name = "433", .freq_min = 433050000, .freq_max = 434790000, .duty_permille = 100},
+    {.name = "868", .freq_min = 868000000, .freq_max = 868600000, .duty_permille = 10},
+};
+#define DUTY_BAND_COUNT COUNT_OF(duty_bands)
+// One active step per restricted band, plus one unrestricted step per radio
+#define STEP_SLOT_COUNT (DUTY_BAND_COUNT + RADIO_MAX)
+#define STEP_SLOT_NONE 0xFF
+
+// --- Radio Setups ---
+typedef enum {
+    RadioSetupInternal,
+    RadioSetupInternalExternal,
+    RadioSetupSimulated,
+    RadioSetupSimulatedDual,
+    RadioSetupInternalFifo, // Packet mode through the TX FIFO
+    RadioSetupSimulatedFifo,
+    RadioSetupCount
+} RadioSetup;
+static const char* const radio_setup_names[] =
+    {"Internal", "Int + Ext", "Sim x1", "Sim x2", "Int FIFO", "Sim FIFO"};
+
 // --- View ID ---
 typedef enum {
     ViewIdMenu,
@@ -567,15 +730,48 @@ typedef enum {
     // ViewIdSavedCodes,
     ViewIdAttack,
     ViewIdAbout,
+    ViewIdSettings,
+    ViewIdQueue,
     // ViewIdDirections,
 } OpenSesameViewId;
 
+// Views allocated on first navigation and released on return to the menu
+static const OpenSesameViewId opensesame_lazy_views[] = {
+    ViewIdAttackMode,
+    ViewIdTargetSelect,
+    ViewIdConfig,
+    ViewIdAttack,
+    ViewIdAbout,
+    ViewIdSettings,
+    ViewIdQueue,
+};
+
+// --- Custom Events ---
+typedef enum {
+    OpenSesameEventReleaseViews,
+    OpenSesameEventQueueChanged,
+    OpenSesameEventCliStart,
+    OpenSesameEventCliStop,
+    OpenSesameEventTunePing, // Answered by the GUI thread to time its latency
+} OpenSesameCustomEvent;
+
+// --- Attack View Pages ---
+typedef enum {
+    AttackPageProgress,
+    AttackPageTelemetry,
+    AttackPageJitter,
+    AttackPageCount
+} AttackPage;
+
 // --- Submenu Items ---
 typedef enum {
     SubmenuIndexStartAttack,
     SubmenuIndexAttackMode,
     SubmenuIndexTargetSelect,
     SubmenuIndexShowConfig,
+    SubmenuIndexSettings,
+    SubmenuIndexJobQueue,
+    SubmenuIndexAutoTune,
     // SubmenuIndexCodeBuffer,
     // SubmenuIndexSavedCodes,
     // SubmenuIndexDirections,
@@ -583,13 +779,545 @@ typedef enum {
     SubmenuIndexExit,
 } SubmenuIndex;
 
+// --- Job Queue Menu Items ---
+typedef enum {
+    QueueIndexAdd,
+    QueueIndexRun,
+    QueueIndexSave,
+    QueueIndexLoad,
+    QueueIndexClear,
+    QueueIndexJobBase, // Followed by one item per queued job
+} QueueIndex;
+
+// --- Job Queue ---
+typedef enum {
+    JobOptionDriftSweep = (1 << 0),
+    JobOptionRateSweep = (1 << 1),
+} JobOption;
+
+typedef struct {
+    uint8_t target_index; // Any user-selectable target, groups included
+    uint8_t attack_mode;
+    uint8_t options; // JobOption flags
+} OpenSesameJob;
+
 // --- Code Buffer Structure ---
+// Codes are added as chunks are encoded, which can be a chunk ahead of the
+// radio. Every code gets a sequence number, and the codes of chunks that
+// are encoded but not on air yet are left out wherever the buffer is read.
+typedef struct {
+    uint32_t first; // Sequence numbers [first, end)
+    uint32_t end;
+} CodeRange;
+
 typedef struct {
     uint32_t codes[CODE_BUFFER_SIZE];
     uint32_t head; // Points to the OLDEST code
     uint32_t count; // Number of items in buffer
+    uint32_t pushed; // Sequence number of the next code
+    CodeRange pending[STEP_SLOT_COUNT]; // Per step slot, encoded ahead
 } CodeBuffer;
 
+// Chunk a radio started last, for hits: its target and newest code
+typedef struct {
+    uint8_t target;
+    uint32_t codes; // Complete codes in the chunk, 0 = none yet
+    uint32_t last_code;
+} OnAirChunk;
+
+// --- Code Space ---
+// A code is 'n' digits, sent first digit first. Every digit takes 'radix'
+// symbols except mixed-radix positions in 'binary_mask', which take 0/1.
+// Code values read the digits as a mixed-radix number, first digit most
+// significant, so a uniform space gives the usual base-k value.
+typedef struct {
+    uint8_t n;
+    uint8_t radix;
+    uint32_t binary_mask;
+} CodeSpace;
+
+// --- Code Order Structure ---
+typedef struct {
+    uint32_t prior[PRIOR_CODES_MAX]; // High-prior codes, in emission order
+    uint32_t sorted[PRIOR_CODES_MAX]; // Same codes, sorted for lookups
+    uint8_t prior_count;
+    uint8_t prior_pos;
+    uint32_t next_code; // Next numeric candidate after the priors
+    uint32_t max_code;
+} CodeOrder;
+
+// --- Clock Structure ---
+// Time as the worker and TX path see it. The device clock follows the tick
+// counter and DWT. The virtual clock only moves when something waits on
+// it, so a dry run of a whole plan on simulated radios takes seconds.
+typedef struct Clock Clock;
+
+typedef struct {
+    uint64_t (*now_us)(Clock* clock);
+    void (*delay_us)(Clock* clock, uint32_t us);
+} ClockOps;
+
+struct Clock {
+    const ClockOps* ops;
+    uint32_t start_tick;
+    uint32_t start_cycles;
+    uint32_t cycles_per_us;
+    uint64_t virtual_us; // Two words on Cortex-M4: only touched in a critical section
+    uint32_t virtual_waits;
+};
+
+// --- Airtime Governor Structure ---
+typedef struct {
+    uint32_t slot_us[DUTY_SLOTS]; // Airtime charged per minute, ring
+    uint8_t head; // Slot of the current minute
+    uint32_t head_tick; // Start of the current minute
+    uint32_t window_us; // Sum of slot_us
+} AirtimeLedger;
+
+typedef struct {
+    AirtimeLedger ledgers[DUTY_BAND_COUNT];
+    Clock* clock; // Ledger ticks are this clock's milliseconds
+} AirtimeGovernor;
+
+// --- Sequence Cache Structures ---
+typedef struct {
+    uint8_t k;
+    uint8_t n;
+    uint8_t pins; // Steps currently reading this entry
+    uint32_t num_codes;
+    uint32_t prior_offset; // Rotation covering high-prior windows earliest
+    uint32_t last_used; // Tick, for LRU eviction
+    uint8_t* packed; // NULL = free slot
+} SequenceCacheEntry;
+
+typedef struct {
+    SequenceCacheEntry entries[SEQUENCE_CACHE_SLOTS];
+    size_t bytes; // Packed bytes held
+    uint32_t hits;
+    uint32_t misses;
+    uint16_t pack_loads; // Misses streamed from a pack on SD
+    uint16_t pack_damaged; // Pack blocks that failed their CRC
+    uint32_t pack_bytes_read; // From SD, this session
+    FuriMutex* mutex; // Shared by the worker and the prefetch thread
+    volatile uint16_t generating; // PREFETCH_KEY being prefetched, 0 = none
+} SequenceCache;
+
+// --- de Bruijn Stream Structure ---
+// Generator state, see the de Bruijn Generator section
+typedef struct {
+    uint8_t k;
+    uint8_t n;
+    uint8_t word[CODE_DIGITS_MAX + 1]; // 1-based prenecklace
+    uint8_t length; // Of the Lyndon word being emitted
+    uint8_t position; // Next digit of it, 1-based
+} DeBruijnStream;
+
+// --- Sequence Pack Structures ---
+// On SD: PackHeader, block_count PackIndexEntry records, then block_count
+// blocks of block_bytes bytes (the last one zero padded), each followed by
+// its CRC-32. Every byte holds digits_per_byte base-k digits, lowest first:
+// 8 binary digits, 5 trits or 4 quaternary digits.
+typedef enum {
+    PackGeneratorUnknown = 0, // Digits can be read but not rebuilt
+    PackGeneratorFkm = 1, // DeBruijnStream
+} PackGenerator;
+
+typedef struct {
+    uint32_t magic;
+    uint16_t version;
+    uint8_t k;
+    uint8_t n;
+    uint8_t generator; // PackGenerator
+    uint8_t digits_per_byte;
+    uint16_t reserved;
+    uint32_t digits;
+    uint16_t block_digits;
+    uint16_t block_count;
+    uint16_t block_bytes;
+    uint16_t index_entry_size;
+    uint32_t prior_offset; // Rotation for the prior set below
+    uint32_t prior_key; // pack_prior_key of the prior set at write time
+    uint32_t crc; // Of the fields above
+} PackHeader;
+
+// Where a block starts in the sequence, and the generator state there, so
+// a damaged block is rebuilt without replaying every block before it
+typedef struct {
+    uint32_t first_digit;
+    uint8_t length; // DeBruijnStream state
+    uint8_t position;
+    uint16_t reserved;
+    uint8_t word[PACKED_SEQUENCE_BYTES(CODE_DIGITS_MAX)]; // word[1..n], 2 bits each
+    uint32_t crc; // Of the fields above
+} PackIndexEntry;
+
+typedef enum {
+    PackBlockUnchecked,
+    PackBlockGood,
+    PackBlockRepaired, // Failed its CRC, rebuilt from the generator
+    PackBlockSkipped, // Failed its CRC, its digits are not sent
+} PackBlockState;
+
+typedef struct PackReader PackReader;
+
+// A de Bruijn sequence held in RAM, streamed from its pack, or generated as
+// it is read. A generator can only be read in order, wrapping at the end.
+typedef struct {
+    const uint8_t* packed;
+    PackReader* pack;
+    DeBruijnStream* stream;
+} SequenceSource;
+
+// --- Attack Plan Structures ---
+// Where a de Bruijn step gets its digits, fastest first; part of the
+// session.evl format like EventType
+typedef enum {
+    SequenceStrategyCache = 0, // Already generated this session
+    SequenceStrategyRam = 1, // Generated into the cache, or owned by the step
+    SequenceStrategyPack = 2, // Streamed from its pack on SD
+    SequenceStrategyStream = 3, // Generated digit by digit as it is sent
+    SequenceStrategyCount,
+} SequenceStrategy;
+
+static const char* const sequence_strategy_names[] = {"cache", "ram", "pack", "stream"};
+
+typedef struct {
+    uint8_t target_idx[PLAN_MAX_STEPS];
+    uint8_t strategy[PLAN_MAX_STEPS]; // SequenceStrategy when compiled, de Bruijn only
+    uint8_t count;
+} AttackPlan;
+
+typedef enum {
+    StepBeginOk,
+    StepBeginSkip,
+    StepBeginFailed,
+    StepBeginStopped,
+} StepBeginResult;
+
+typedef struct {
+    uint8_t target_idx;
+    const OpenSesameTarget* target;
+    uint8_t k;
+    uint8_t n;
+    uint8_t band;
+    bool active;
+    CodeSpace space; // Codes sent by this step
+    uint32_t sent; // Codes (de Bruijn: digits) emitted so far
+    uint32_t num_codes;
+    CodeOrder order;
+    // Compatibility / Stream
+    size_t payload_size_bytes;
+    // de Bruijn
+    SequenceCacheEntry* sequence; // Cache entry, or owned_sequence if uncached
+    SequenceCacheEntry owned_sequence;
+    SequenceStrategy strategy;
+    PackReader* pack; // SequenceStrategyPack
+    bool pack_unwritten; // Generated here, written as a pack when the step ends
+    DeBruijnStream stream; // SequenceStrategyStream
+    SequenceSource source; // Digits, from one of the above
+    uint32_t divisor;
+    uint32_t start_offset;
+    uint32_t total_digits;
+    uint32_t code_register;
+    uint8_t window_digits; // Digits in code_register since the last gap, up to n
+    // Run history and report
+    uint64_t airtime_us;
+    uint32_t start_ms;
+    uint64_t setup_us; // Loading the step, tuning and TX beyond nominal airtime
+    uint64_t gap_us; // Scheduler gaps after its transmissions
+    uint64_t yield_us; // Ticks given up while generating or between codes
+    uint64_t idle_us; // Duty-cycle waits and pauses while it was active
+    uint64_t shared_us; // Other steps on air while it waited for a radio
+} AttackStep;
+
+// --- TX Timing Structures ---
+// Async TX edges are clocked out by timer DMA, so what the CPU can observe
+// is how far each chunk's on-air time (DWT cycle counter, start of TX to
+// radio completion) strays from its nominal length.
+static const uint16_t jitter_bucket_limits_us[JITTER_BUCKET_COUNT - 1] = {50, 100, 200, 500, 1000, 2000};
+static const char* const jitter_bucket_names[JITTER_BUCKET_COUNT] = {
+    "<50", "<100", "<200", "<500", "<1k", "<2k", "2k+"};
+
+typedef struct {
+    uint32_t buckets[JITTER_BUCKET_COUNT];
+    uint32_t worst_us;
+    uint32_t chunks;
+} JitterHistogram;
+
+// --- TX Priority ---
+static const FuriThreadPriority tx_priority_values[] = {
+    FuriThreadPriorityNormal,
+    FuriThreadPriorityHigh,
+    FuriThreadPriorityHighest,
+};
+static const char* const tx_priority_names[] = {"Normal", "High", "Highest"};
+
+// --- Event Log ---
+// Values are part of the session.evl format: append, never renumber
+typedef enum {
+    EventSessionStart = 0, // a = CPU MHz
+    EventRunStart = 1, // arg = mode, a = target index, b = radios
+    EventRunEnd = 2, // a = result, b = codes sent
+    EventPlan = 3, // arg = steps, a = aggregate codes
+    EventStepBegin = 4, // arg = target, a = k << 8 | n, b = codes
+    EventStepSkip = 5, // arg = target, a = bits
+    EventStepEnd = 6, // arg = target, a = codes (de Bruijn: digits) sent
+    EventCacheHit = 7, // arg = k, a = n
+    EventCacheMiss = 8, // arg = k, a = n
+    EventCacheFull = 9, // arg = k, a = n
+    EventPrefetch = 10, // arg = k, a = n, b = cached
+    EventPriorOffset = 11, // arg = target, a = prior codes, b = start digit
+    EventTxStart = 12, // arg = radio, a = frequency, b = nominal us
+    EventTxEnd = 13, // arg = radio, a = elapsed us, b = nominal us
+    EventTxRefused = 14, // arg = radio, a = frequency
+    EventDutyWait = 15, // a = ms
+    EventJobStart = 16, // arg = job, a = target, b = mode
+    EventDropped = 17, // a = records lost to a full ring
+    EventSpanBegin = 18, // arg = TraceSpan, a = track, b = detail
+    EventSpanEnd = 19, // arg = TraceSpan, a = track
+    EventForecast = 20, // arg = short of charge, a = needed mAh, b = usable mAh
+    EventStepTrim = 21, // arg = target, a = estimated wall s
+    EventPackLoad = 22, // arg = k, a = n, b = blocks
+    EventPackWrite = 23, // arg = k, a = n, b = written
+    EventPackDamaged = 24, // arg = PackBlockState, a = k << 8 | n, b = block
+    EventStrategy = 25, // arg = target, a = SequenceStrategy, b = free heap bytes
+    EventTuning = 26, // arg = gap ms, a = chunk airtime ms, b = yield digits
+    EventReconcile = 27, // arg = target, a = wall time per mille of estimate, b = overhead per mille
+} EventType;
+
+// Phases shown on the trace timeline; part of the format like EventType
+typedef enum {
+    TraceSpanStep = 0, // detail = target
+    TraceSpanGenerate = 1, // detail = k << 8 | n
+    TraceSpanEncode = 2, // detail = 1 when encoded ahead
+    TraceSpanRadioSetup = 3, // detail = RadioSetup
+    TraceSpanRadioWait = 4, // detail = radio
+    TraceSpanSleep = 5, // detail = ms
+    TraceSpanRedraw = 6, // detail = attack page
+} TraceSpan;
+
+// What the worker is doing for the stop benchmark: its open span on the
+// worker track plus one, or 0 while it schedules between spans
+#define WORKER_PHASE_SCHEDULING 0
+#define WORKER_PHASE_COUNT 8
+static const char* const worker_phase_names[WORKER_PHASE_COUNT] = {
+    "schedule", "step", "generate", "encode", "radio_setup", "radio_wait", "sleep", "redraw"};
+
+// Timeline rows: a span begins and ends on the same track
+typedef enum {
+    TraceTrackWorker = 1,
+    TraceTrackGui = 2,
+    TraceTrackPrefetch = 3,
+    TraceTrackStep = 10, // + step slot
+    TraceTrackRadio = 20, // + radio, on-air time from EventTxStart / EventTxEnd
+} TraceTrack;
+
+static const char* const trace_span_names[] = {
+    "step", "generate", "encode", "radio_setup", "radio_wait", "sleep", "redraw"};
+static const char* const event_type_names[] = {
+    "session_start", "run_start", "run_end", "plan", "step_begin", "step_skip", "step_end",
+    "cache_hit", "cache_miss", "cache_full", "prefetch", "prior_offset", "tx_start", "tx_end",
+    "tx_refused", "duty_wait", "job_start", "dropped", "span_begin", "span_end", "forecast",
+    "step_trim", "pack_load", "pack_write", "pack_damaged", "strategy", "tuning", "reconcile"};
+
+typedef struct {
+    uint32_t time_us; // Since the session started, wraps after ~71 minutes
+    uint8_t type; // EventType
+    uint8_t arg;
+    uint16_t commit; // Low bits of the record's sequence number + 1, stored last
+    uint32_t a;
+    uint32_t b;
+} EventRecord;
+
+typedef struct {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t record_size;
+    uint32_t start_tick;
+    uint32_t reserved;
+} EventLogHeader;
+
+// Writers reserve a record with an atomic increment and never block; the
+// flush thread copies committed records to SD in blocks.
+typedef struct {
+    EventRecord* ring;
+    volatile uint32_t head; // Records reserved
+    volatile uint32_t tail; // Records flushed
+    volatile uint32_t dropped;
+    uint32_t start_tick;
+    uint32_t start_cycles;
+    uint32_t cycles_per_us;
+    FuriThread* thread;
+    File* file;
+
+    // Chrome trace export, owned by the flush thread
+    volatile bool trace_wanted; // Spans are only recorded while set
+    File* trace;
+    FuriString* trace_text;
+    uint64_t trace_time_us; // Unwrapped time of the last flushed record
+} EventLog;
+
+// --- Long-Run Mode ---
+// Battery draw measured during the run against the plan's remaining wall time
+typedef struct {
+    uint64_t current_sum_ma; // Discharge samples since the run started
+    uint32_t samples;
+    uint32_t last_sample_tick;
+    uint32_t last_forecast_tick;
+    volatile uint32_t average_ma;
+    volatile uint32_t needed_mah; // To finish the plan at average_ma
+    volatile uint32_t usable_mah; // Remaining charge less the reserve
+    volatile uint8_t trimmed; // Plan targets dropped this run
+    volatile bool charging;
+    volatile bool shortfall;
+} PowerForecast;
+
+// --- Run History Structures ---
+// Every run is appended to HISTORY_PATH as one record per step it ran
+// followed by a run record; whole records are never rewritten. HISTORY_INDEX_PATH
+// holds the records folded into aggregates per target and mode, plus how
+// much of the history they cover, so only newer records are read again.
+typedef enum {
+    HistoryRecordStep = 1,
+    HistoryRecordRun = 2,
+    HistoryRecordHit = 3, // Marked by the operator while the code was on air
+} HistoryRecordType;
+
+typedef enum {
+    HistoryStopCompleted = 0,
+    HistoryStopUser = 1,
+    HistoryStopFailed = 2,
+} HistoryStop;
+
+typedef struct {
+    uint8_t type; // HistoryRecordType
+    uint8_t mode; // AttackMode
+    uint8_t target; // Run: the selection; step and hit: the plan target
+    uint8_t status; // Run: HistoryStop; step: 1 = every code sent
+    uint32_t run; // RTC timestamp of the run start
+    uint32_t codes; // Codes sent; hit: the code
+    uint32_t total; // Codes in the step or plan
+    uint32_t airtime_ms;
+    uint32_t wall_ms;
+    uint32_t estimate_ms; // Airtime the estimator predicted
+    uint8_t steps; // Run: step records before it
+    uint8_t radios;
+    uint8_t options; // JobOption flags
+    uint8_t strategy; // de Bruijn step: SequenceStrategy
+} HistoryRecord;
+
+typedef struct {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t record_size;
+    uint32_t created; // RTC timestamp, ties the index to this file
+    uint32_t reserved;
+} HistoryHeader;
+
+typedef struct {
+    uint8_t target;
+    uint8_t mode;
+    uint8_t hit_count;
+    uint8_t reserved;
+    uint16_t runs; // Steps run for this target
+    uint16_t completed; // Of those, steps that sent every code
+    uint32_t last_run;
+    uint32_t hits[HISTORY_HITS_MAX]; // Newest first
+    uint64_t airtime_ms;
+    uint64_t wall_ms;
+} HistoryAggregate;
+
+typedef struct {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t entry_size;
+    uint32_t history_created;
+    uint32_t history_bytes; // HISTORY_PATH size folded into the entries
+    uint32_t count;
+} HistoryIndexHeader;
+
+typedef enum {
+    HitSlotFree,
+    HitSlotWriting, // Claimed by the GUI or CLI
+    HitSlotReady, // For the worker to append
+} HitSlot;
+
+typedef struct {
+    FuriMutex* mutex; // Worker appends runs and hits, the GUI and CLI read
+    bool loaded;
+    HistoryAggregate* entries;
+    uint16_t count;
+    uint32_t history_created;
+    uint32_t history_bytes;
+
+    // Run in progress, worker only. NULL in dry runs.
+    HistoryRecord* run_steps; // Room for every plan step and the run record
+    uint8_t run_step_count;
+    uint8_t run_step_max;
+    uint32_t run_id;
+    uint32_t run_start_ms;
+    volatile bool hit_marked; // Shown until the next run
+    volatile uint32_t hit_code;
+
+    // Hit marked on the GUI or CLI, appended by the worker: HitSlot
+    HistoryRecord hit;
+    uint8_t hit_slot;
+} RunHistory;
+
+// --- Run Report ---
+// Every step that ran against what the estimator predicts for the share of
+// its target it sent. Overhead is the step's wall time beyond its airtime,
+// less the time it could not have used: duty-cycle waits, pauses and other
+// steps on air. What setup, gaps and yields do not explain is left as other.
+typedef struct {
+    uint8_t target;
+    bool flagged; // Overhead above REPORT_OVERHEAD_FLAG_PERMILLE of airtime
+    uint32_t estimate_airtime_ms;
+    uint32_t airtime_ms;
+    uint32_t estimate_wall_ms;
+    uint32_t wall_ms;
+    uint32_t setup_ms;
+    uint32_t gap_ms;
+    uint32_t yield_ms;
+    uint32_t idle_ms;
+    uint32_t shared_ms;
+    uint32_t overhead_ms;
+} ReportStep;
+
+typedef struct {
+    ReportStep* steps; // PLAN_MAX_STEPS, allocated by the first run
+    volatile uint8_t count; // Raised by the worker once the step is written
+    uint8_t flagged;
+    uint64_t estimate_airtime_ms;
+    uint64_t airtime_ms;
+    uint64_t overhead_ms;
+} RunReport;
+
+// Scheduler gaps, chunk size and generation yields, picked per device by
+// the auto-tuner; the defaults are the original fixed values
+typedef struct {
+    uint32_t chunk_airtime_ms; // 0 = PAYLOADS_PER_CHUNK payloads
+    uint32_t variant_gap_ms; // After every transmission
+    uint32_t chunk_gap_ms; // More once a chunk's variants are out
+    uint32_t target_gap_ms; // Between targets in meta-modes
+    uint32_t yield_digits; // Generation sleeps a tick once per this many digits
+
+    // What the last calibration measured, 0 = untuned
+    uint32_t setup_us; // Per transmission beyond its airtime
+    uint32_t callback_ppm; // Extra wall time per unit of airtime
+    uint32_t tick_us; // A 1 ms sleep
+    uint32_t digit_ns; // Generating one de Bruijn digit
+    uint32_t ui_latency_us; // GUI event turnaround while on air
+} TxTuning;
+
+static const TxTuning tuning_defaults = {
+    .chunk_airtime_ms = 0,
+    .variant_gap_ms = 5,
+    .chunk_gap_ms = 5,
+    .target_gap_ms = 100,
+    .yield_digits = 1024,
+};
+
 // --- App Structure ---
 typedef struct {
     Gui* gui;
@@ -601,16 +1329,53 @@ typedef struct {
     Widget* config_widget;
     Widget* about_widget;
     Widget* directions_widget;
+    VariableItemList* settings_list;
+    Submenu* queue_menu;
     // View* buffer_view;
     // View* saved_codes_view;
     View* attack_view;
+    OpenSesameViewId current_view;
 
     uint8_t current_target_index;
     AttackMode attack_mode;
     uint8_t about_page; // 0-3: Thank You, About, Usage, License
+    bool drift_sweep; // Repeat each chunk on the target's frequency offsets
+    bool rate_sweep; // Repeat each chunk at every bit period variant
+    uint8_t attack_page; // AttackPage shown by the attack view
+    uint8_t tx_priority; // Index into tx_priority_values for the worker while sending
+    RadioSetup radio_setup; // Transmitters the scheduler spreads steps over
+    bool long_run; // Backlight off, idle radios asleep, plan fitted to the battery
+    bool dry_run; // Simulated radios on virtual time
+    Clock device_clock;
+    Clock virtual_clock; // Restarted by each dry run
+    Clock* clock; // What the worker and radios time the current run with
+
+    // Job queue
+    OpenSesameJob jobs[JOB_QUEUE_MAX];
+    uint8_t job_count;
+    bool queue_run; // Worker runs the queue instead of the current selection
+    bool tune_run; // Worker calibrates instead of attacking
+    bool stop_bench; // Worker runs for the stop benchmark: simulated radios, nothing recorded
+    volatile uint8_t worker_phase; // WORKER_PHASE_*, for the stop benchmark
+    volatile uint8_t job_index;
+    char queue_status[24]; // Queue menu header
+    uint32_t queue_selected; // Queue menu item to reselect after a rebuild
+    char queue_summary[40]; // Result of the last queue run
+    char tune_summary[32]; // Result of the last calibration
+
+    // CLI
+    Cli* cli;
+    bool cli_start_queue; // Consumed by OpenSesameEventCliStart
+    bool cli_start_tune;
+    bool cli_start_bench;
+    volatile bool cli_busy; // A command callback is still running
+    volatile bool cli_closing; // Ends a running "watch" before the app is freed
     
     // Code buffer
     CodeBuffer code_buffer;
+    OnAirChunk on_air[RADIO_MAX];
+    uint8_t on_air_latest; // Radio that started a chunk last
+    uint32_t on_air_writes; // Odd while the worker updates on_air
     // uint8_t selected_buffer_index;
     
     // Attack state
@@ -621,643 +1386,4334 @@ typedef struct {
     volatile uint32_t codes_transmitted;
     volatile uint8_t current_attack_target_idx;
     uint32_t max_code;
+    volatile bool duty_waiting;
+    volatile uint8_t radio_count; // Radios that started for this run
+    volatile bool paused; // Scheduler idles between chunks, steps stay resumable
+    volatile uint64_t variant_airtime_us[BIT_PERIOD_VARIANTS_MAX]; // Per bit period, this run
+    JitterHistogram jitter; // On-air timing error per chunk, this run
+    PowerForecast forecast; // Long-run mode, this run
+    volatile uint8_t sequence_strategy; // SequenceStrategy of the latest de Bruijn step
+    uint16_t strategy_steps[SequenceStrategyCount]; // de Bruijn steps by strategy, this run
+    AirtimeGovernor governor; // Kept across runs: duty cycle spans the hour
+    TxTuning tuning; // Loaded for this device and firmware at startup
+    volatile uint32_t tune_ping_us; // Device clock, cleared by the GUI's answer
+    volatile uint32_t tune_latency_us;
+    SequenceCache sequence_cache; // Kept across retries, freed on exit
+    RunHistory history; // Loaded on first use
+    RunReport report; // Latest run, kept until the next one starts
+    EventLog event_log; // Whole app session, flushed to EVENT_LOG_PATH
     const char* attack_animation_chars;
     uint8_t attack_animation_index;
 } OpenSesameApp;
 
-// --- Forward Declarations ---
-static void opensesame_push_code_to_buffer(OpenSesameApp* app, uint32_t code);
-static void about_widget_setup(OpenSesameApp* app);
+// --- Clock ---
+// DWT wraps every ~67 s at 64 MHz: the tick counter says how many times
+static uint64_t dwt_elapsed_us(uint32_t start_tick, uint32_t start_cycles, uint32_t cycles_per_us) {
+    const uint32_t elapsed_ms = furi_get_tick() - start_tick;
+    const uint32_t cycles = DWT->CYCCNT - start_cycles;
+    const uint64_t expected = (uint64_t)elapsed_ms * 1000 * cycles_per_us;
+    const uint64_t wraps = (expected + (1ULL << 31) - cycles) >> 32;
+    return ((wraps << 32) + cycles) / cycles_per_us;
+}
 
-// --- Code Buffer Management ---
-static void opensesame_push_code_to_buffer(OpenSesameApp* app, uint32_t code) {
-    if(app == NULL) return;
-    
-    CodeBuffer* buffer = &app->code_buffer;
-    
-    uint32_t next_idx = (buffer->head + buffer->count) % CODE_BUFFER_SIZE;
+static uint64_t clock_device_now_us(Clock* clock) {
+    return dwt_elapsed_us(clock->start_tick, clock->start_cycles, clock->cycles_per_us);
+}
 
-    if(buffer->count == CODE_BUFFER_SIZE) {
-        buffer->head = (buffer->head + 1) % CODE_BUFFER_SIZE;
+static void clock_device_delay_us(Clock* clock, uint32_t us) {
+    UNUSED(clock);
+    if(us >= 1000) {
+        furi_delay_ms(us / 1000);
     } else {
-        buffer->count++;
+        furi_delay_us(us);
     }
-    
-    buffer->codes[next_idx] = code;
 }
 
-// --- Payload Generation ---
-static void opensesame_generate_payload(
-    uint32_t code,
-    const OpenSesameTarget* target,
-    uint8_t* payload_buffer,
-    size_t payload_buffer_size) {
-    if(target == NULL || payload_buffer == NULL) return;
-    
-    memset(payload_buffer, 0, payload_buffer_size);
-
-    uint32_t temp_code = code;
-    uint32_t divisor = 1;
-    uint32_t base = target->trinary ? 3 : 2;
+// The worker advances the virtual clock while the GUI, CLI and prefetch
+// threads read it, so neither may see one word of an update without the other
+static uint64_t clock_virtual_now_us(Clock* clock) {
+    FURI_CRITICAL_ENTER();
+    const uint64_t now_us = clock->virtual_us;
+    FURI_CRITICAL_EXIT();
+    return now_us;
+}
 
-    if(target->bits > 0) {
-        if((!target->trinary && target->bits > 31) || (target->trinary && target->bits > 19)) {
-            divisor = 0;
-        } else if (target->bits > 1) {
-             divisor = (uint32_t)pow(base, target->bits - 1);
-        }
+// Waiting is instant, but the GUI, log flush and prefetch threads still
+// need the CPU now and then
+static void clock_virtual_delay_us(Clock* clock, uint32_t us) {
+    FURI_CRITICAL_ENTER();
+    clock->virtual_us += us;
+    FURI_CRITICAL_EXIT();
+    if(++clock->virtual_waits % CLOCK_VIRTUAL_SLEEP_EVERY == 0) {
+        furi_delay_tick(1);
+    } else {
+        furi_thread_yield();
     }
+}
 
-    size_t current_bit_index = 0;
-    for(uint8_t i = 0; i < target->bits; i++) {
-        uint8_t digit = (divisor > 0) ? (temp_code / divisor) : temp_code;
-        if(divisor > 0) {
-            temp_code %= divisor;
-            divisor /= base;
-        }
+static const ClockOps clock_device_ops = {
+    .now_us = clock_device_now_us,
+    .delay_us = clock_device_delay_us,
+};
 
-        uint32_t bit_pattern;
-        if(digit == 0)
-            bit_pattern = target->b0;
-        else if(digit == 1)
-            bit_pattern = target->b1;
-        else
-            bit_pattern = target->b2;
+static const ClockOps clock_virtual_ops = {
+    .now_us = clock_virtual_now_us,
+    .delay_us = clock_virtual_delay_us,
+};
 
-        for(uint8_t j = 0; j < target->length; j++) {
-            bool bit_is_set = (bit_pattern >> (target->length - 1 - j)) & 1;
-            if(bit_is_set) {
-                size_t byte_index = current_bit_index / 8;
-                size_t bit_in_byte_index = 7 - (current_bit_index % 8);
-                payload_buffer[byte_index] |= (1 << bit_in_byte_index);
-            }
-            current_bit_index++;
-        }
-    }
+static void clock_init(Clock* clock, bool is_virtual) {
+    memset(clock, 0, sizeof(Clock));
+    clock->ops = is_virtual ? &clock_virtual_ops : &clock_device_ops;
+    clock->start_tick = furi_get_tick();
+    clock->start_cycles = DWT->CYCCNT;
+    clock->cycles_per_us = furi_hal_cortex_instructions_per_microsecond();
 }
 
-// --- Transmission ---
-typedef struct {
-    uint8_t* buffer;
-    size_t size;
-    size_t position;
-} TxContext;
+static inline uint64_t clock_now_us(Clock* clock) {
+    return clock->ops->now_us(clock);
+}
 
-static LevelDuration opensesame_tx_callback(void* context) {
-    if(context == NULL) return level_duration_reset();
-    
-    TxContext* tx_ctx = (TxContext*)context;
+// Wraps like furi_get_tick: compare with signed differences
+static inline uint32_t clock_now_ms(Clock* clock) {
+    return (uint32_t)(clock->ops->now_us(clock) / 1000);
+}
 
-    if(tx_ctx->position >= tx_ctx->size * 8) {
-        return level_duration_reset();
-    }
+static inline void clock_delay_ms(Clock* clock, uint32_t ms) {
+    clock->ops->delay_us(clock, ms * 1000);
+}
 
-    size_t byte_idx = tx_ctx->position / 8;
-    size_t bit_idx = 7 - (tx_ctx->position % 8);
-    bool bit_value = (tx_ctx->buffer[byte_idx] >> bit_idx) & 1;
+static inline void clock_delay_us(Clock* clock, uint32_t us) {
+    clock->ops->delay_us(clock, us);
+}
 
-    tx_ctx->position++;
+// --- Cancellation ---
+// The worker and prefetch threads only see a stop at these points. CPU work
+// between two of them is bounded by STOP_LATENCY_BOUND_MS, and sleeps end
+// as soon as the stop is requested.
+static inline bool worker_stop_requested(void) {
+    return (furi_thread_flags_get() & WORKER_EVENT_STOP) != 0;
+}
 
-    uint32_t duration = 650;
-    return level_duration_make(bit_value, duration);
+// clock_delay_ms that wakes early on a stop. Returns true if stopped.
+static bool clock_sleep_ms(Clock* clock, uint32_t ms) {
+    if(clock->ops != &clock_device_ops) {
+        clock_delay_ms(clock, ms);
+        return worker_stop_requested();
+    }
+    const uint32_t flags = furi_thread_flags_wait(
+        WORKER_EVENT_STOP, FuriFlagWaitAny | FuriFlagNoClear, furi_ms_to_ticks(ms));
+    return !(flags & FuriFlagError) && (flags & WORKER_EVENT_STOP);
 }
 
-static void opensesame_transmit_raw(uint32_t frequency, uint8_t* buffer, size_t size) {
-    if(buffer == NULL || size == 0) return;
-    
-    TxContext tx_ctx = {.buffer = buffer, .size = size, .position = 0};
+// --- Event Log ---
+static uint32_t event_log_now_us(const EventLog* log) {
+    return (uint32_t)dwt_elapsed_us(log->start_tick, log->start_cycles, log->cycles_per_us);
+}
 
-    furi_hal_subghz_reset();
-    furi_hal_subghz_load_custom_preset(opensesame_ook_preset_data);
-    furi_hal_subghz_set_frequency_and_path(frequency);
+// Safe from any thread and never blocks: a full ring drops the record
+static void event_log_write(EventLog* log, EventType type, uint8_t arg, uint32_t a, uint32_t b) {
+    if(log->ring == NULL) return;
 
-    if(furi_hal_subghz_start_async_tx(opensesame_tx_callback, &tx_ctx)) {
-        while(tx_ctx.position < size * 8) {
-            if(furi_thread_flags_get() & WORKER_EVENT_STOP) {
-                furi_hal_subghz_stop_async_tx();
-                furi_hal_subghz_sleep();
-                return;
-            }
-            furi_delay_ms(10);
+    uint32_t head = __atomic_load_n(&log->head, __ATOMIC_RELAXED);
+    do {
+        if(head - __atomic_load_n(&log->tail, __ATOMIC_ACQUIRE) >= EVENT_LOG_RECORDS) {
+            __atomic_fetch_add(&log->dropped, 1, __ATOMIC_RELAXED);
+            return;
         }
-        furi_hal_subghz_stop_async_tx();
-    }
+    } while(!__atomic_compare_exchange_n(
+        &log->head, &head, head + 1, true, __ATOMIC_ACQ_REL, __ATOMIC_RELAXED));
+
+    EventRecord* record = &log->ring[head & (EVENT_LOG_RECORDS - 1)];
+    record->time_us = event_log_now_us(log);
+    record->type = type;
+    record->arg = arg;
+    record->a = a;
+    record->b = b;
+    __atomic_store_n(&record->commit, (uint16_t)(head + 1), __ATOMIC_RELEASE);
+}
 
-    furi_hal_subghz_sleep();
-    furi_delay_ms(5);
+// --- Trace Export ---
+// Chrome trace-event JSON (chrome://tracing, ui.perfetto.dev). Spans become
+// begin/end pairs on their track, TX start/end the on-air time of each radio
+// and every other event an instant on the worker track.
+static void trace_append_time(FuriString* text, uint64_t time_us) {
+    const uint32_t sec = time_us / 1000000;
+    const uint32_t usec = time_us % 1000000;
+    if(sec > 0) {
+        furi_string_cat_printf(text, "%lu%06lu", sec, usec);
+    } else {
+        furi_string_cat_printf(text, "%lu", usec);
+    }
 }
 
-// --- Helper for de Bruijn ---
-static size_t opensesame_append_digit_pattern(
-    uint8_t digit,
-    const OpenSesameTarget* target,
-    uint8_t* buffer,
-    size_t bit_offset) {
-    if(target == NULL || buffer == NULL) return bit_offset;
-    
-    uint32_t bit_pattern;
-    if(digit == 0)
-        bit_pattern = target->b0;
-    else if(digit == 1)
-        bit_pattern = target->b1;
-    else
-        bit_pattern = target->b2;
+static void trace_append_record(FuriString* text, const EventRecord* record, uint64_t time_us) {
+    const char* name;
+    char phase;
+    uint32_t track;
+
+    if(record->type == EventSpanBegin || record->type == EventSpanEnd) {
+        if(record->arg >= COUNT_OF(trace_span_names)) return;
+        name = trace_span_names[record->arg];
+        phase = (record->type == EventSpanBegin) ? 'B' : 'E';
+        track = record->a;
+    } else if(record->type == EventTxStart || record->type == EventTxEnd) {
+        name = "on_air";
+        phase = (record->type == EventTxStart) ? 'B' : 'E';
+        track = TraceTrackRadio + record->arg;
+    } else if(record->type < COUNT_OF(event_type_names)) {
+        name = event_type_names[record->type];
+        phase = 'i';
+        track = TraceTrackWorker;
+    } else {
+        return;
+    }
 
-    size_t current_bit_index = bit_offset;
-    for(uint8_t j = 0; j < target->length; j++) {
-        bool bit_is_set = (bit_pattern >> (target->length - 1 - j)) & 1;
-        if(bit_is_set) {
-            size_t byte_index = current_bit_index / 8;
-            size_t bit_in_byte_index = 7 - (current_bit_index % 8);
-            buffer[byte_index] |= (1 << bit_in_byte_index);
-        }
-        current_bit_index++;
+    furi_string_cat_printf(
+        text, ",\n{\"name\":\"%s\",\"ph\":\"%c\",\"pid\":1,\"tid\":%lu,\"ts\":", name, phase, track);
+    trace_append_time(text, time_us);
+    if(record->type == EventSpanBegin) {
+        furi_string_cat_printf(text, ",\"args\":{\"detail\":%lu}", record->b);
+    } else if(record->type == EventTxStart) {
+        furi_string_cat_printf(
+            text, ",\"args\":{\"freq\":%lu,\"nominal_us\":%lu}", record->a, record->b);
+    } else if(record->type == EventTxEnd) {
+        furi_string_cat_printf(text, ",\"args\":{\"elapsed_us\":%lu}", record->a);
+    } else if(phase == 'i') {
+        furi_string_cat_printf(
+            text, ",\"s\":\"t\",\"args\":{\"arg\":%u,\"a\":%lu,\"b\":%lu}",
+            record->arg, record->a, record->b);
     }
-    return current_bit_index;
+    furi_string_cat_str(text, "}");
 }
 
-// --- Worker Functions ---
-
-static int32_t opensesame_worker_compatibility(OpenSesameApp* app, const OpenSesameTarget* target) {
-    UNUSED(target); // We use app->current_target_index
-    
-    // Target loop logic
-    bool is_all_known = (app->current_target_index == 4);
-    bool is_generic_brute = (app->current_target_index == 5);
-    bool is_european_brute = (app->current_target_index == 6);
+static void trace_append_track_name(FuriString* text, uint32_t track, const char* name, int index) {
+    furi_string_cat_printf(
+        text, ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%lu,\"args\":{\"name\":\"%s",
+        track, name);
+    if(index >= 0) furi_string_cat_printf(text, " %d", index);
+    furi_string_cat_str(text, "\"}}");
+}
 
-    uint8_t target_start = 0;
-    uint8_t target_end = 0;
+static void event_log_trace_write(EventLog* log) {
+    storage_file_write(
+        log->trace, furi_string_get_cstr(log->trace_text), furi_string_size(log->trace_text));
+    furi_string_reset(log->trace_text);
+}
 
-    if(is_generic_brute) {
-        target_start = 0;
-        target_end = 67; // Index of last generic target
-    } else if(is_all_known) {
-        target_start = 0;
-        target_end = 3; 
-    } else if(is_european_brute) {
-        target_start = 68; // Index of first European target
-        target_end = opensesame_total_target_count - 1; // 81
-    } else {
-        target_start = app->current_target_index;
-        target_end = app->current_target_index;
+// Starts a new trace file; records flushed before this are not in it
+static void event_log_trace_open(EventLog* log) {
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+    log->trace = storage_file_alloc(storage);
+    if(!storage_file_open(log->trace, TRACE_PATH, FSAM_WRITE, FSOM_CREATE_ALWAYS)) {
+        FURI_LOG_W("OpenSesame", "Trace file not writable, tracing off");
+        storage_file_free(log->trace);
+        log->trace = NULL;
+        log->trace_wanted = false;
+        furi_record_close(RECORD_STORAGE);
+        return;
     }
 
-    for(uint8_t target_idx = target_start; target_idx <= target_end; target_idx++) {
-        if(target_idx == 4 || target_idx == 5 || target_idx == 6) continue; // Skip meta-targets
-        if(furi_thread_flags_get() & WORKER_EVENT_STOP) break;
+    FuriString* text = log->trace_text;
+    furi_string_set_str(
+        text, "[{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"OpenSesame\"}}");
+    trace_append_track_name(text, TraceTrackWorker, "Worker", -1);
+    trace_append_track_name(text, TraceTrackGui, "GUI", -1);
+    trace_append_track_name(text, TraceTrackPrefetch, "Prefetch", -1);
+    for(uint8_t s = 0; s < STEP_SLOT_COUNT; s++) {
+        trace_append_track_name(text, TraceTrackStep + s, "Step slot", s);
+    }
+    for(uint8_t r = 0; r < RADIO_MAX; r++) {
+        trace_append_track_name(text, TraceTrackRadio + r, "Radio", r + 1);
+    }
+    event_log_trace_write(log);
+}
 
-        const OpenSesameTarget* current_target = &opensesame_targets[target_idx];
-        app->current_attack_target_idx = target_idx; // For saving
-        FURI_LOG_I("OpenSesame", "Compat: Starting %s", current_target->name);
+static void event_log_trace_close(EventLog* log) {
+    storage_file_write(log->trace, "\n]\n", 3);
+    storage_file_close(log->trace);
+    storage_file_free(log->trace);
+    log->trace = NULL;
+    furi_record_close(RECORD_STORAGE);
+}
 
-        // Calculate max_code for *this specific target*
-        const uint8_t n = current_target->bits;
-        const uint8_t k = current_target->trinary ? 3 : 2;
-        if((!current_target->trinary && n > 31) || (current_target->trinary && n > 19)) {
-            FURI_LOG_W("OpenSesame", "Target %s too large, skipping", current_target->name);
-            continue; 
+// Converts a run of flushed records and keeps the 64-bit clock going.
+// Writers can be preempted between reserving and stamping a record, so a
+// record may be slightly older than the one before it.
+static void event_log_trace_records(EventLog* log, const EventRecord* records, uint32_t count) {
+    for(uint32_t i = 0; i < count; i++) {
+        const int32_t delta = (int32_t)(records[i].time_us - (uint32_t)log->trace_time_us);
+        uint64_t time_us = log->trace_time_us + delta;
+        if(delta > 0) {
+            log->trace_time_us = time_us;
+        } else if((uint64_t)(-(int64_t)delta) > log->trace_time_us) {
+            time_us = 0;
         }
-        uint32_t target_max_code = (uint32_t)pow(k, n);
+        if(log->trace == NULL) continue;
 
-        if(target_max_code == 0) {
-             FURI_LOG_W("OpenSesame", "Target %s max code is 0, skipping", current_target->name);
-            continue;
-        }
+        trace_append_record(log->trace_text, &records[i], time_us);
+        if(furi_string_size(log->trace_text) >= TRACE_WRITE_BYTES) event_log_trace_write(log);
+    }
 
-        size_t total_bits_per_payload = current_target->bits * current_target->length;
-        size_t payload_size_bytes = (total_bits_per_payload + 7) / 8;
-        
-        uint8_t* payload_buffer = malloc(payload_size_bytes);
-        if(payload_buffer == NULL) {
-            FURI_LOG_E("OpenSesame", "Failed to allocate payload buffer");
-            return -1;
-        }
+    if(log->trace != NULL && furi_string_size(log->trace_text) > 0) event_log_trace_write(log);
+}
 
-        for(uint32_t code = 0; code < target_max_code; code++) {
-            if(furi_thread_flags_get() & WORKER_EVENT_STOP) break;
+// Writes every committed record in runs that do not wrap the ring
+static void event_log_flush(EventLog* log) {
+    uint32_t tail = log->tail;
+    const uint32_t head = __atomic_load_n(&log->head, __ATOMIC_ACQUIRE);
 
-            app->current_code = code; // For inner-loop display
-            app->codes_transmitted++; // For global progress bar
+    if(log->trace_wanted && log->trace == NULL && log->trace_text != NULL) {
+        event_log_trace_open(log);
+    }
 
-            opensesame_generate_payload(code, current_target, payload_buffer, payload_size_bytes);
-            opensesame_transmit_raw(current_target->frequency, payload_buffer, payload_size_bytes);
-            opensesame_push_code_to_buffer(app, code);
-            
-            if(code % 10 == 0) {
-                furi_delay_ms(1);
-            }
+    while(tail != head) {
+        const uint32_t start = tail & (EVENT_LOG_RECORDS - 1);
+        uint32_t count = 0;
+        while(tail + count != head && start + count < EVENT_LOG_RECORDS &&
+              __atomic_load_n(&log->ring[start + count].commit, __ATOMIC_ACQUIRE) ==
+                  (uint16_t)(tail + count + 1)) {
+            count++;
         }
-        free(payload_buffer);
+        if(count == 0) break; // Next record still being written
 
-        // Delay between targets in meta-modes
-        if((is_all_known || is_generic_brute || is_european_brute) && target_idx < target_end) {
-            if(target_idx + 1 != 4 && target_idx + 1 != 5 && target_idx + 1 != 6) {
-                furi_delay_ms(100);
-            }
+        if(log->file != NULL) {
+            storage_file_write(log->file, &log->ring[start], count * sizeof(EventRecord));
         }
+        event_log_trace_records(log, &log->ring[start], count);
+        tail += count;
+        __atomic_store_n(&log->tail, tail, __ATOMIC_RELEASE);
     }
-    return 0;
-}
 
-static int32_t opensesame_worker_stream(OpenSesameApp* app, const OpenSesameTarget* target) {
-    UNUSED(target); // We use app->current_target_index
+    uint32_t dropped = __atomic_exchange_n(&log->dropped, 0, __ATOMIC_RELAXED);
+    if(dropped > 0) event_log_write(log, EventDropped, 0, dropped, 0);
 
-    // Target loop logic
-    bool is_all_known = (app->current_target_index == 4);
-    bool is_generic_brute = (app->current_target_index == 5);
-    bool is_european_brute = (app->current_target_index == 6);
+    if(!log->trace_wanted && log->trace != NULL) event_log_trace_close(log);
+}
 
-    uint8_t target_start = 0;
-    uint8_t target_end = 0;
+static int32_t event_log_thread(void* context) {
+    EventLog* log = (EventLog*)context;
+    while(!(furi_thread_flags_wait(WORKER_EVENT_STOP, FuriFlagWaitAny, EVENT_LOG_FLUSH_MS) &
+            WORKER_EVENT_STOP)) {
+        event_log_flush(log);
+    }
+    event_log_flush(log);
+    event_log_flush(log); // Picks up the EventDropped record of the first pass
+    return 0;
+}
 
-    if(is_generic_brute) {
-        target_start = 0;
-        target_end = 67; // Index of last generic target
-    } else if(is_all_known) {
-        target_start = 0;
-        target_end = 3; 
-    } else if(is_european_brute) {
-        target_start = 68; // Index of first European target
-        target_end = opensesame_total_target_count - 1; // 81
+// Starts a new session file; logging stays off if there is no memory
+static void event_log_start(EventLog* log) {
+    memset(log, 0, sizeof(EventLog));
+    log->ring = malloc(sizeof(EventRecord) * EVENT_LOG_RECORDS);
+    if(log->ring == NULL) return;
+    memset(log->ring, 0, sizeof(EventRecord) * EVENT_LOG_RECORDS);
+    log->trace_text = furi_string_alloc();
+
+    log->cycles_per_us = furi_hal_cortex_instructions_per_microsecond();
+    log->start_tick = furi_get_tick();
+    log->start_cycles = DWT->CYCCNT;
+
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+    log->file = storage_file_alloc(storage);
+    if(storage_file_open(log->file, EVENT_LOG_PATH, FSAM_WRITE, FSOM_CREATE_ALWAYS)) {
+        EventLogHeader header = {
+            .magic = EVENT_LOG_MAGIC,
+            .version = EVENT_LOG_VERSION,
+            .record_size = sizeof(EventRecord),
+            .start_tick = log->start_tick,
+        };
+        storage_file_write(log->file, &header, sizeof(header));
     } else {
-        target_start = app->current_target_index;
-        target_end = app->current_target_index;
+        FURI_LOG_W("OpenSesame", "Event log not writable, keeping it in RAM only");
+        storage_file_free(log->file);
+        log->file = NULL;
     }
 
-    for(uint8_t target_idx = target_start; target_idx <= target_end; target_idx++) {
-        if(target_idx == 4 || target_idx == 5 || target_idx == 6) continue; // Skip meta-targets
-        if(furi_thread_flags_get() & WORKER_EVENT_STOP) break;
-
-        const OpenSesameTarget* current_target = &opensesame_targets[target_idx];
-        app->current_attack_target_idx = target_idx; // For saving
-        FURI_LOG_I("OpenSesame", "Stream: Starting %s", current_target->name);
-
-        // Calculate max_code for *this specific target*
-        const uint8_t n = current_target->bits;
-        const uint8_t k = current_target->trinary ? 3 : 2;
-        if((!current_target->trinary && n > 31) || (current_target->trinary && n > 19)) {
-            FURI_LOG_W("OpenSesame", "Target %s too large, skipping", current_target->name);
-            continue; 
-        }
-        uint32_t target_max_code = (uint32_t)pow(k, n);
+    log->thread = furi_thread_alloc_ex("OpenSesameLog", 1024, event_log_thread, log);
+    if(log->thread != NULL) {
+        furi_thread_set_priority(log->thread, FuriThreadPriorityLow);
+        furi_thread_start(log->thread);
+    }
+    event_log_write(log, EventSessionStart, 0, log->cycles_per_us, 0);
+}
 
-        if(target_max_code == 0) {
-             FURI_LOG_W("OpenSesame", "Target %s max code is 0, skipping", current_target->name);
-            continue;
-        }
+static void event_log_stop(EventLog* log) {
+    if(log->thread != NULL) {
+        furi_thread_flags_set(furi_thread_get_id(log->thread), WORKER_EVENT_STOP);
+        furi_thread_join(log->thread);
+        furi_thread_free(log->thread);
+    }
+    if(log->trace != NULL) event_log_trace_close(log);
+    if(log->trace_text != NULL) furi_string_free(log->trace_text);
+    if(log->file != NULL) {
+        storage_file_close(log->file);
+        storage_file_free(log->file);
+    }
+    if(log->ring != NULL) {
+        furi_record_close(RECORD_STORAGE);
+    }
+    free(log->ring);
+    memset(log, 0, sizeof(EventLog));
+}
 
-        size_t total_bits_per_payload = current_target->bits * current_target->length;
-        size_t payload_size_bytes = (total_bits_per_payload + 7) / 8;
-        
-        uint8_t* single_payload = malloc(payload_size_bytes);
-        if(single_payload == NULL) {
-            FURI_LOG_E("OpenSesame", "Failed to allocate single payload");
-            return -1;
-        }
+#define OPENSESAME_EVENT(app, type, arg, a, b) \
+    event_log_write(&(app)->event_log, (type), (uint8_t)(arg), (uint32_t)(a), (uint32_t)(b))
+
+// Spans cost two records each, so they are only recorded while tracing;
+// the worker's phase is kept either way
+#define OPENSESAME_SPAN_BEGIN(app, span, track, detail)                   \
+    do {                                                                  \
+        if((track) == TraceTrackWorker) (app)->worker_phase = (span) + 1; \
+        if((app)->event_log.trace_wanted)                                 \
+            OPENSESAME_EVENT(app, EventSpanBegin, span, track, detail);   \
+    } while(0)
+#define OPENSESAME_SPAN_END(app, span, track)                                 \
+    do {                                                                      \
+        if((track) == TraceTrackWorker) (app)->worker_phase = WORKER_PHASE_SCHEDULING; \
+        if((app)->event_log.trace_wanted)                                     \
+            OPENSESAME_EVENT(app, EventSpanEnd, span, track, 0);              \
+    } while(0)
 
-        size_t chunk_size = payload_size_bytes * PAYLOADS_PER_CHUNK;
-        uint8_t* chunk_buffer = malloc(chunk_size);
-        if(chunk_buffer == NULL) {
-            FURI_LOG_E("OpenSesame", "Failed to allocate chunk buffer");
-            free(single_payload);
-            return -1;
-        }
+// --- Forward Declarations ---
+static void opensesame_push_code_to_buffer(OpenSesameApp* app, uint32_t code);
+static void about_widget_setup(OpenSesameApp* app);
+static void opensesame_switch_to_view(OpenSesameApp* app, OpenSesameViewId view_id);
+static uint8_t pack_reader_digit(PackReader* reader, uint32_t index);
+static uint8_t debruijn_stream_next(DeBruijnStream* stream);
+static void run_report_record_step(OpenSesameApp* app, const AttackStep* step);
 
-        size_t current_in_chunk = 0;
-        memset(chunk_buffer, 0, chunk_size);
+// --- Code Buffer Management ---
+static void opensesame_push_code_to_buffer(OpenSesameApp* app, uint32_t code) {
+    if(app == NULL) return;
+    
+    CodeBuffer* buffer = &app->code_buffer;
+    
+    uint32_t next_idx = (buffer->head + buffer->count) % CODE_BUFFER_SIZE;
+
+    if(buffer->count == CODE_BUFFER_SIZE) {
+        buffer->head = (buffer->head + 1) % CODE_BUFFER_SIZE;
+    } else {
+        buffer->count++;
+    }
+    
+    buffer->codes[next_idx] = code;
+    buffer->pushed++;
+}
+
+static bool code_buffer_pending(const CodeBuffer* buffer, uint32_t sequence) {
+    for(uint8_t s = 0; s < STEP_SLOT_COUNT; s++) {
+        const CodeRange* range = &buffer->pending[s];
+        if(sequence - range->first < range->end - range->first) return true;
+    }
+    return false;
+}
+
+// Worker only. Readers on other threads retry while the count is odd.
+static void on_air_set(OpenSesameApp* app, uint8_t radio, const OnAirChunk* chunk) {
+    const uint32_t writes = __atomic_load_n(&app->on_air_writes, __ATOMIC_RELAXED);
+    __atomic_store_n(&app->on_air_writes, writes + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    app->on_air[radio] = *chunk;
+    app->on_air_latest = radio;
+    __atomic_store_n(&app->on_air_writes, writes + 2, __ATOMIC_RELEASE);
+}
+
+// The chunk a radio started last
+static void on_air_get(OpenSesameApp* app, OnAirChunk* chunk) {
+    uint32_t writes;
+    do {
+        writes = __atomic_load_n(&app->on_air_writes, __ATOMIC_ACQUIRE);
+        *chunk = app->on_air[app->on_air_latest];
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    } while((writes & 1) || writes != __atomic_load_n(&app->on_air_writes, __ATOMIC_RELAXED));
+}
+
+// The 'skip'-th newest code that went on air, 0 = the newest
+static bool code_buffer_sent(const CodeBuffer* buffer, uint32_t skip, uint32_t* code) {
+    const uint32_t count = buffer->count;
+    for(uint32_t i = count; i > 0; i--) {
+        if(code_buffer_pending(buffer, buffer->pushed - count + i - 1)) continue;
+        if(skip-- == 0) {
+            *code = buffer->codes[(buffer->head + i - 1) % CODE_BUFFER_SIZE];
+            return true;
+        }
+    }
+    return false;
+}
+
+// --- Packed Sequences ---
+// de Bruijn digits are stored 4 per byte, 2 bits each, lowest bits first
+static inline uint8_t opensesame_packed_digit(const uint8_t* packed, uint32_t index) {
+    return (packed[index / 4] >> ((index % 4) * 2)) & 0x3;
+}
+
+static inline void opensesame_packed_set_digit(uint8_t* packed, uint32_t index, uint8_t digit) {
+    packed[index / 4] |= (digit & 0x3) << ((index % 4) * 2);
+}
+
+// Generators ignore 'index' and return their next digit
+static inline uint8_t opensesame_sequence_digit(const SequenceSource* source, uint32_t index) {
+    if(source->packed != NULL) return opensesame_packed_digit(source->packed, index);
+    if(source->pack != NULL) return pack_reader_digit(source->pack, index);
+    return debruijn_stream_next(source->stream);
+}
+
+// --- Code Spaces ---
+static inline uint8_t code_space_radix_at(const CodeSpace* space, uint8_t position) {
+    return ((space->binary_mask >> position) & 1) ? 2 : space->radix;
+}
+
+// Number of codes; anything above UINT32_MAX only needs to compare larger
+static uint64_t code_space_count(const CodeSpace* space) {
+    uint64_t count = 1;
+    for(uint8_t i = 0; i < space->n && count <= UINT32_MAX; i++) {
+        count *= code_space_radix_at(space, i);
+    }
+    return count;
+}
+
+// Splits a code value into its digits, first-sent digit first
+static void code_space_digits(const CodeSpace* space, uint32_t value, uint8_t* digits) {
+    for(int i = space->n - 1; i >= 0; i--) {
+        const uint8_t radix = code_space_radix_at(space, i);
+        digits[i] = value % radix;
+        value /= radix;
+    }
+}
+
+// A de Bruijn window can start on any digit, so every digit of the
+// sequence needs the full alphabet: mixed radix only narrows the spaces
+// that are sent code by code
+static CodeSpace opensesame_target_code_space(const OpenSesameTarget* target, AttackMode mode) {
+    return (CodeSpace){
+        .n = target->bits,
+        .radix = target->radix,
+        .binary_mask = (mode == AttackModeDeBruijn) ? 0 : target->binary_mask,
+    };
+}
+
+static uint64_t opensesame_target_code_count(const OpenSesameTarget* target, AttackMode mode) {
+    const CodeSpace space = opensesame_target_code_space(target, mode);
+    return code_space_count(&space);
+}
+
+// --- Code Ordering ---
+// Codes are not equally likely: factory defaults and simple DIP patterns
+// (all off, all on, alternating) are tried first, then every remaining
+// code in numeric order. Total work is unchanged, only the order moves.
+static int prior_code_compare(const void* a, const void* b) {
+    uint32_t lhs = *(const uint32_t*)a;
+    uint32_t rhs = *(const uint32_t*)b;
+    return (lhs > rhs) - (lhs < rhs);
+}
+
+static bool code_order_is_prior(const CodeOrder* order, uint32_t code) {
+    return bsearch(&code, order->sorted, order->prior_count, sizeof(uint32_t),
+               prior_code_compare) != NULL;
+}
+
+static void code_order_add_prior(CodeOrder* order, uint32_t code) {
+    if(order->prior_count >= PRIOR_CODES_MAX || code >= order->max_code) return;
+
+    for(uint8_t i = 0; i < order->prior_count; i++) {
+        if(order->prior[i] == code) return;
+    }
+    order->prior[order->prior_count++] = code;
+}
+
+// Digit strings are written first-transmitted digit first, e.g. "0101010101"
+static bool code_order_parse_digits(const char* text, const CodeSpace* space, uint32_t* code) {
+    if(strlen(text) != space->n) return false;
+
+    uint32_t value = 0;
+    for(uint8_t i = 0; i < space->n; i++) {
+        const uint8_t radix = code_space_radix_at(space, i);
+        if(text[i] < '0' || text[i] >= '0' + radix) return false;
+        value = (value * radix) + (uint32_t)(text[i] - '0');
+    }
+    *code = value;
+    return true;
+}
+
+static void code_order_load_file(CodeOrder* order, const CodeSpace* space) {
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+    Stream* stream = file_stream_alloc(storage);
+    FuriString* line = furi_string_alloc();
+
+    if(file_stream_open(stream, PRIOR_CODES_PATH, FSAM_READ, FSOM_OPEN_EXISTING)) {
+        while(stream_read_line(stream, line)) {
+            furi_string_trim(line, " \t\r\n");
+            const char* text = furi_string_get_cstr(line);
+            if(text[0] == '#' || text[0] == '\0') continue;
+
+            uint32_t code;
+            if(code_order_parse_digits(text, space, &code)) {
+                code_order_add_prior(order, code);
+            }
+        }
+    }
+
+    file_stream_close(stream);
+    stream_free(stream);
+    furi_string_free(line);
+    furi_record_close(RECORD_STORAGE);
+}
+
+// Code whose digits alternate 'even', 'odd' by position, each digit
+// clamped to what its position allows
+static uint32_t code_order_pattern(const CodeSpace* space, uint8_t even, uint8_t odd) {
+    uint32_t code = 0;
+    for(uint8_t i = 0; i < space->n; i++) {
+        const uint8_t radix = code_space_radix_at(space, i);
+        code = (code * radix) + MIN((i % 2) ? odd : even, radix - 1);
+    }
+    return code;
+}
+
+static void code_order_add_builtin(CodeOrder* order, const CodeSpace* space) {
+    // All positions set to the same digit (all off, all on, all float, ...)
+    for(uint8_t d = 0; d < space->radix; d++) {
+        code_order_add_prior(order, code_order_pattern(space, d, d));
+    }
+
+    // Alternating pairs (0101..., 1010..., and the multi-level combinations)
+    for(uint8_t a = 0; a < space->radix; a++) {
+        for(uint8_t b = 0; b < space->radix; b++) {
+            if(a != b) code_order_add_prior(order, code_order_pattern(space, a, b));
+        }
+    }
+}
+
+static void code_order_sort(CodeOrder* order) {
+    memcpy(order->sorted, order->prior, order->prior_count * sizeof(uint32_t));
+    qsort(order->sorted, order->prior_count, sizeof(uint32_t), prior_code_compare);
+}
+
+// Codes in 'first' (hits from the run history) go ahead of every other prior
+static void code_order_init(
+    CodeOrder* order,
+    const CodeSpace* space,
+    const uint32_t* first,
+    uint8_t first_count) {
+    memset(order, 0, sizeof(CodeOrder));
+    order->max_code = (uint32_t)code_space_count(space);
+
+    for(uint8_t i = 0; i < first_count; i++) {
+        code_order_add_prior(order, first[i]);
+    }
+    code_order_load_file(order, space);
+    code_order_add_builtin(order, space);
+    code_order_sort(order);
+}
+
+static bool code_order_next(CodeOrder* order, uint32_t* code) {
+    if(order->prior_pos < order->prior_count) {
+        *code = order->prior[order->prior_pos++];
+        return true;
+    }
+
+    while(order->next_code < order->max_code) {
+        uint32_t candidate = order->next_code++;
+        if(!code_order_is_prior(order, candidate)) {
+            *code = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+// de Bruijn sequences are cyclic, so any rotation still covers every code.
+// Pick the rotation that completes the last high-prior window soonest:
+// start right after the largest gap between prior windows.
+static uint32_t code_order_debruijn_offset(
+    const CodeOrder* order,
+    const SequenceSource* source,
+    uint32_t num_codes,
+    uint8_t k,
+    uint8_t n) {
+    if(order->prior_count == 0) return 0;
+
+    const uint32_t divisor = (uint32_t)pow(k, n - 1);
+    uint32_t window = 0;
+    for(uint8_t i = 0; i < n - 1; i++) {
+        window = (window * k) + opensesame_sequence_digit(source, i);
+    }
+
+    uint32_t first_pos = 0, prev_pos = 0, best_start = 0, best_gap = 0;
+    bool found = false;
+    for(uint32_t start = 0; start < num_codes; start++) {
+        // Stopped: any offset will do, the step is not sent
+        if(start % STOP_CHECK_DIGITS == 0 && worker_stop_requested()) return 0;
+
+        // Window beginning at 'start' ends at start + n - 1 (cyclic)
+        window = ((window % divisor) * k) +
+                 opensesame_sequence_digit(source, (start + n - 1) % num_codes);
+        if(!code_order_is_prior(order, window)) continue;
+
+        if(!found) {
+            first_pos = start;
+            found = true;
+        } else if(start - prev_pos > best_gap) {
+            best_gap = start - prev_pos;
+            best_start = start;
+        }
+        prev_pos = start;
+    }
+    if(!found) return 0;
+
+    // Wrap-around gap from the last prior window back to the first
+    if(num_codes - prev_pos + first_pos > best_gap) {
+        best_start = first_pos;
+    }
+    return best_start;
+}
+
+// --- Payload Generation ---
+static uint32_t opensesame_digit_pattern(const OpenSesameTarget* target, uint8_t digit) {
+    switch(digit) {
+    case 0:
+        return target->b0;
+    case 1:
+        return target->b1;
+    case 2:
+        return target->b2;
+    default:
+        return target->b3;
+    }
+}
+
+static void opensesame_generate_payload(
+    uint32_t code,
+    const OpenSesameTarget* target,
+    const CodeSpace* space,
+    uint8_t* payload_buffer,
+    size_t payload_buffer_size) {
+    if(target == NULL || payload_buffer == NULL) return;
+    
+    memset(payload_buffer, 0, payload_buffer_size);
+
+    uint8_t digits[CODE_DIGITS_MAX];
+    code_space_digits(space, code, digits);
+
+    size_t current_bit_index = 0;
+    for(uint8_t i = 0; i < space->n; i++) {
+        uint32_t bit_pattern = opensesame_digit_pattern(target, digits[i]);
+
+        for(uint8_t j = 0; j < target->length; j++) {
+            bool bit_is_set = (bit_pattern >> (target->length - 1 - j)) & 1;
+            if(bit_is_set) {
+                size_t byte_index = current_bit_index / 8;
+                size_t bit_in_byte_index = 7 - (current_bit_index % 8);
+                payload_buffer[byte_index] |= (1 << bit_in_byte_index);
+            }
+            current_bit_index++;
+        }
+    }
+}
+
+// --- Transmission ---
+typedef struct {
+    uint8_t* buffer;
+    size_t size;
+    size_t position;
+    uint32_t bit_period_us;
+} TxContext;
+
+// Packet-mode TX: the encoded chunk goes through the CC1101's TX FIFO at a
+// data rate matching the bit period, topped up each time the FIFO drains
+// below its threshold, so no CPU time is spent per bit edge
+typedef struct {
+    const uint8_t* data;
+    size_t size;
+    volatile size_t written; // Bytes handed to the FIFO
+    uint32_t period_ns; // Bit period after data-rate rounding
+    uint8_t drate_e;
+    uint8_t drate_m;
+    FuriThread* thread; // Refills on the threshold interrupt
+    uint32_t refills;
+    uint32_t underflows;
+    uint32_t length_errors; // Simulated: PKTLEN 0 programmed, which no chunk may need
+
+    // Simulated FIFO: the model replays threshold crossings at their own times
+    uint64_t model_ns; // Time of the FIFO access being modelled, from TX start
+    uint32_t model_packet; // Bytes the programmed length lets out, 0 = not set
+} FifoTx;
+
+typedef struct RadioSession RadioSession;
+
+// One transmitter. Transmissions are started without blocking so several
+// radios can be on air at once; the scheduler waits for whichever ends first.
+typedef struct {
+    const char* name;
+    bool (*begin)(RadioSession* radio); // Reset and load the OOK preset
+    void (*end)(RadioSession* radio);
+    void (*tune)(RadioSession* radio, uint32_t frequency);
+    bool (*start_tx)(RadioSession* radio);
+    bool (*is_tx_complete)(RadioSession* radio);
+    void (*stop_tx)(RadioSession* radio);
+    void (*sleep)(RadioSession* radio); // Power down while idle
+    void (*wake)(RadioSession* radio); // Restore the preset, frequency is retuned
+
+    // Packet-mode backends only
+    uint8_t (*fifo_level)(RadioSession* radio); // Bytes waiting in the TX FIFO
+    void (*fifo_write)(RadioSession* radio, const uint8_t* data, uint8_t size);
+} RadioBackend;
+
+struct RadioSession {
+    const RadioBackend* backend;
+    Clock* clock; // The run's clock: device time, or virtual on simulated radios
+    const SubGhzDevice* device; // External CC1101 only
+    bool otg_enabled; // We powered the external module and turn it off again
+    uint32_t frequency; // Currently tuned frequency, 0 = not tuned
+    bool asleep; // Woken by the next transmission
+
+    // Transmission on air
+    volatile bool busy;
+    TxContext tx;
+    uint32_t nominal_us;
+    uint64_t start_us;
+    uint32_t simulated_us; // Simulated radio: length of the encoded levels
+    uint32_t elapsed_us; // Measured length of the last transmission
+    FifoTx fifo;
+};
+
+typedef struct {
+    RadioSession radios[RADIO_MAX];
+    uint8_t count;
+} RadioSet;
+
+static LevelDuration opensesame_tx_callback(void* context) {
+    if(context == NULL) return level_duration_reset();
+    
+    TxContext* tx_ctx = (TxContext*)context;
+
+    if(tx_ctx->position >= tx_ctx->size * 8) {
+        return level_duration_reset();
+    }
+
+    // Merge runs of equal bits into a single level to cut callback count
+    const size_t total_bits = tx_ctx->size * 8;
+    const bool level = (tx_ctx->buffer[tx_ctx->position / 8] >> (7 - (tx_ctx->position % 8))) & 1;
+    uint32_t run = 0;
+
+    do {
+        tx_ctx->position++;
+        run++;
+    } while(tx_ctx->position < total_bits &&
+            ((tx_ctx->buffer[tx_ctx->position / 8] >> (7 - (tx_ctx->position % 8))) & 1) == level);
+
+    return level_duration_make(level, run * tx_ctx->bit_period_us);
+}
+
+static void jitter_histogram_record(JitterHistogram* histogram, uint32_t error_us) {
+    uint8_t bucket = 0;
+    while(bucket < JITTER_BUCKET_COUNT - 1 && error_us >= jitter_bucket_limits_us[bucket]) {
+        bucket++;
+    }
+    histogram->buckets[bucket]++;
+    histogram->chunks++;
+    if(error_us > histogram->worst_us) histogram->worst_us = error_us;
+}
+
+// Internal CC1101 through furi_hal_subghz
+static bool radio_internal_begin(RadioSession* radio) {
+    UNUSED(radio);
+    furi_hal_subghz_reset();
+    furi_hal_subghz_load_custom_preset(opensesame_ook_preset_data);
+    return true;
+}
+
+static void radio_internal_end(RadioSession* radio) {
+    UNUSED(radio);
+    furi_hal_subghz_sleep();
+}
+
+static void radio_internal_tune(RadioSession* radio, uint32_t frequency) {
+    UNUSED(radio);
+    furi_hal_subghz_idle();
+    furi_hal_subghz_set_frequency_and_path(frequency);
+}
+
+static bool radio_internal_start_tx(RadioSession* radio) {
+    return furi_hal_subghz_start_async_tx(opensesame_tx_callback, &radio->tx);
+}
+
+static bool radio_internal_is_tx_complete(RadioSession* radio) {
+    UNUSED(radio);
+    return furi_hal_subghz_is_async_tx_complete();
+}
+
+static void radio_internal_stop_tx(RadioSession* radio) {
+    UNUSED(radio);
+    furi_hal_subghz_stop_async_tx();
+}
+
+static void radio_internal_sleep(RadioSession* radio) {
+    UNUSED(radio);
+    furi_hal_subghz_sleep();
+}
+
+// PATABLE and the test registers are lost in sleep: reload everything
+static void radio_internal_wake(RadioSession* radio) {
+    UNUSED(radio);
+    furi_hal_subghz_reset();
+    furi_hal_subghz_load_custom_preset(opensesame_ook_preset_data);
+}
+
+// External CC1101 module on the GPIO header, powered from the 5V pin
+static bool radio_external_begin(RadioSession* radio) {
+    subghz_devices_init();
+    radio->device = subghz_devices_get_by_name(RADIO_EXTERNAL_DEVICE_NAME);
+    radio->otg_enabled = false;
+    if(radio->device != NULL) {
+        radio->otg_enabled = !furi_hal_power_is_otg_enabled();
+        if(radio->otg_enabled) furi_hal_power_enable_otg();
+
+        if(subghz_devices_begin(radio->device)) {
+            if(subghz_devices_is_connect(radio->device)) {
+                subghz_devices_reset(radio->device);
+                subghz_devices_load_preset(
+                    radio->device, FuriHalSubGhzPresetCustom, (uint8_t*)opensesame_ook_preset_data);
+                return true;
+            }
+            subghz_devices_end(radio->device);
+        }
+        if(radio->otg_enabled) furi_hal_power_disable_otg();
+    }
+    subghz_devices_deinit();
+    radio->device = NULL;
+    return false;
+}
+
+static void radio_external_end(RadioSession* radio) {
+    subghz_devices_sleep(radio->device);
+    subghz_devices_end(radio->device);
+    if(radio->otg_enabled) furi_hal_power_disable_otg();
+    subghz_devices_deinit();
+    radio->device = NULL;
+}
+
+static void radio_external_tune(RadioSession* radio, uint32_t frequency) {
+    subghz_devices_idle(radio->device);
+    subghz_devices_set_frequency(radio->device, frequency);
+}
+
+static bool radio_external_start_tx(RadioSession* radio) {
+    return subghz_devices_start_async_tx(radio->device, opensesame_tx_callback, &radio->tx);
+}
+
+static bool radio_external_is_tx_complete(RadioSession* radio) {
+    return subghz_devices_is_async_complete_tx(radio->device);
+}
+
+static void radio_external_stop_tx(RadioSession* radio) {
+    subghz_devices_stop_async_tx(radio->device);
+}
+
+static void radio_external_sleep(RadioSession* radio) {
+    subghz_devices_sleep(radio->device);
+}
+
+static void radio_external_wake(RadioSession* radio) {
+    subghz_devices_reset(radio->device);
+    subghz_devices_load_preset(
+        radio->device, FuriHalSubGhzPresetCustom, (uint8_t*)opensesame_ook_preset_data);
+}
+
+// Simulated radio: runs the encoder to the end and stays "on air" for as
+// long as the levels would take, so scheduling can be tried without TX
+static bool radio_simulated_begin(RadioSession* radio) {
+    UNUSED(radio);
+    return true;
+}
+
+static void radio_simulated_end(RadioSession* radio) {
+    UNUSED(radio);
+}
+
+static void radio_simulated_tune(RadioSession* radio, uint32_t frequency) {
+    UNUSED(radio);
+    UNUSED(frequency);
+}
+
+static bool radio_simulated_start_tx(RadioSession* radio) {
+    radio->simulated_us = 0;
+    for(LevelDuration level = opensesame_tx_callback(&radio->tx); !level_duration_is_reset(level);
+        level = opensesame_tx_callback(&radio->tx)) {
+        radio->simulated_us += level_duration_get_duration(level);
+    }
+    return true;
+}
+
+static bool radio_simulated_is_tx_complete(RadioSession* radio) {
+    return clock_now_us(radio->clock) - radio->start_us >= radio->simulated_us;
+}
+
+static void radio_simulated_stop_tx(RadioSession* radio) {
+    UNUSED(radio);
+}
+
+static void radio_simulated_sleep(RadioSession* radio) {
+    UNUSED(radio);
+}
+
+// CC1101 data rate is (256 + M) * 2^E * f_xosc / 2^28 baud. Picks the
+// register values nearest the bit period and returns the period the radio
+// will actually use, in ns.
+static uint32_t cc1101_data_rate(uint32_t bit_period_us, uint8_t* drate_e, uint8_t* drate_m) {
+    // (256 + M) * 2^E in 1/16 steps
+    const uint64_t target_q4 = ((1ULL << 32) * 1000000ULL) / (bit_period_us * CC1101_XOSC_HZ);
+    uint8_t e = 0;
+    while(e < 15 && (256ULL << (e + 1 + 4)) <= target_q4) e++;
+
+    uint32_t m = (uint32_t)(((target_q4 >> e) + 8) / 16);
+    m = (m > 256) ? m - 256 : 0;
+    if(m > 255) {
+        m = 0;
+        e++;
+    }
+    *drate_e = e;
+    *drate_m = (uint8_t)m;
+    return (uint32_t)(((1ULL << 28) * 1000000000ULL) / (((256ULL + m) << e) * CC1101_XOSC_HZ));
+}
+
+// Tops the FIFO up with the chunk's next bytes. Chunks are at most
+// CHUNK_BYTES_MAX, so each is one fixed-length packet and the radio stops
+// on its last byte.
+static void radio_fifo_refill(RadioSession* radio) {
+    FifoTx* fifo = &radio->fifo;
+    const uint8_t level = radio->backend->fifo_level(radio);
+    const size_t count = MIN((size_t)(CC1101_FIFO_BYTES - level), fifo->size - fifo->written);
+    if(count > 0) {
+        radio->backend->fifo_write(radio, fifo->data + fifo->written, (uint8_t)count);
+        fifo->written += count;
+        fifo->refills++;
+    }
+}
+
+static void radio_fifo_start(RadioSession* radio) {
+    FifoTx* fifo = &radio->fifo;
+    fifo->data = radio->tx.buffer;
+    fifo->size = radio->tx.size;
+    fifo->written = 0;
+    fifo->period_ns = cc1101_data_rate(radio->tx.bit_period_us, &fifo->drate_e, &fifo->drate_m);
+}
+
+// Internal CC1101 in packet mode: the data rate registers are written per
+// chunk, the first 64 bytes are queued before TX is strobed and the rest
+// are written by the refill thread on each GDO0 threshold interrupt
+static void radio_internal_fifo_isr(void* context) {
+    RadioSession* radio = context;
+    furi_thread_flags_set(furi_thread_get_id(radio->fifo.thread), FIFO_EVENT_REFILL);
+}
+
+static int32_t radio_internal_fifo_thread(void* context) {
+    RadioSession* radio = context;
+    while(!(furi_thread_flags_wait(
+                FIFO_EVENT_REFILL | WORKER_EVENT_STOP, FuriFlagWaitAny, FuriWaitForever) &
+            WORKER_EVENT_STOP)) {
+        if(radio->busy) radio_fifo_refill(radio);
+    }
+    return 0;
+}
+
+static uint8_t radio_internal_fifo_level(RadioSession* radio) {
+    UNUSED(radio);
+    uint8_t status = 0;
+    furi_hal_spi_acquire(&furi_hal_spi_bus_handle_subghz);
+    cc1101_read_reg(&furi_hal_spi_bus_handle_subghz, CC1101_STATUS_TXBYTES | CC1101_BURST, &status);
+    furi_hal_spi_release(&furi_hal_spi_bus_handle_subghz);
+    return status & 0x7F;
+}
+
+static void radio_internal_fifo_write(RadioSession* radio, const uint8_t* data, uint8_t size) {
+    UNUSED(radio);
+    furi_hal_spi_acquire(&furi_hal_spi_bus_handle_subghz);
+    cc1101_write_fifo(&furi_hal_spi_bus_handle_subghz, data, size);
+    furi_hal_spi_release(&furi_hal_spi_bus_handle_subghz);
+}
+
+static void radio_internal_fifo_set_length(RadioSession* radio, uint8_t length) {
+    UNUSED(radio);
+    furi_hal_spi_acquire(&furi_hal_spi_bus_handle_subghz);
+    cc1101_write_reg(&furi_hal_spi_bus_handle_subghz, CC1101_PKTLEN, length);
+    furi_hal_spi_release(&furi_hal_spi_bus_handle_subghz);
+}
+
+static bool radio_internal_fifo_begin(RadioSession* radio) {
+    furi_hal_subghz_reset();
+    furi_hal_subghz_load_custom_preset(opensesame_fifo_preset_data);
+
+    radio->fifo.thread =
+        furi_thread_alloc_ex("OpenSesameFifo", 1024, radio_internal_fifo_thread, radio);
+    furi_thread_set_priority(radio->fifo.thread, FuriThreadPriorityHighest);
+    furi_thread_start(radio->fifo.thread);
+
+    furi_hal_gpio_init(&gpio_cc1101_g0, GpioModeInterruptFall, GpioPullNo, GpioSpeedVeryHigh);
+    furi_hal_gpio_add_int_callback(&gpio_cc1101_g0, radio_internal_fifo_isr, radio);
+    return true;
+}
+
+static void radio_internal_fifo_end(RadioSession* radio) {
+    furi_hal_gpio_remove_int_callback(&gpio_cc1101_g0);
+    furi_hal_gpio_init(&gpio_cc1101_g0, GpioModeAnalog, GpioPullNo, GpioSpeedLow);
+
+    furi_thread_flags_set(furi_thread_get_id(radio->fifo.thread), WORKER_EVENT_STOP);
+    furi_thread_join(radio->fifo.thread);
+    furi_thread_free(radio->fifo.thread);
+    radio->fifo.thread = NULL;
+    furi_hal_subghz_sleep();
+}
+
+static bool radio_internal_fifo_start_tx(RadioSession* radio) {
+    radio_fifo_start(radio);
+
+    furi_hal_spi_acquire(&furi_hal_spi_bus_handle_subghz);
+    cc1101_switch_to_idle(&furi_hal_spi_bus_handle_subghz);
+    cc1101_flush_tx(&furi_hal_spi_bus_handle_subghz);
+    cc1101_write_reg(&furi_hal_spi_bus_handle_subghz, CC1101_MDMCFG4, 0x80 | radio->fifo.drate_e);
+    cc1101_write_reg(&furi_hal_spi_bus_handle_subghz, CC1101_MDMCFG3, radio->fifo.drate_m);
+    furi_hal_spi_release(&furi_hal_spi_bus_handle_subghz);
+
+    radio_internal_fifo_set_length(radio, (uint8_t)radio->fifo.size);
+    radio_fifo_refill(radio);
+
+    furi_hal_spi_acquire(&furi_hal_spi_bus_handle_subghz);
+    cc1101_switch_to_tx(&furi_hal_spi_bus_handle_subghz);
+    furi_hal_spi_release(&furi_hal_spi_bus_handle_subghz);
+    return true;
+}
+
+// Done once the chunk's airtime has passed and the radio has dropped back
+// to idle (MCSM1) or stopped on an underflow. Before that, MARCSTATE can
+// still read idle from before the STX strobe took effect.
+static bool radio_internal_fifo_is_tx_complete(RadioSession* radio) {
+    if(clock_now_us(radio->clock) - radio->start_us < radio->nominal_us) return false;
+    uint8_t state = 0;
+    furi_hal_spi_acquire(&furi_hal_spi_bus_handle_subghz);
+    cc1101_read_reg(&furi_hal_spi_bus_handle_subghz, CC1101_STATUS_MARCSTATE | CC1101_BURST, &state);
+    furi_hal_spi_release(&furi_hal_spi_bus_handle_subghz);
+
+    state &= 0x1F;
+    if(state == 0x16) radio->fifo.underflows++; // TXFIFO_UNDERFLOW
+    return state == 0x01 || state == 0x16;
+}
+
+static void radio_internal_fifo_stop_tx(RadioSession* radio) {
+    UNUSED(radio);
+    furi_hal_spi_acquire(&furi_hal_spi_bus_handle_subghz);
+    cc1101_switch_to_idle(&furi_hal_spi_bus_handle_subghz);
+    cc1101_flush_tx(&furi_hal_spi_bus_handle_subghz);
+    furi_hal_spi_release(&furi_hal_spi_bus_handle_subghz);
+}
+
+static void radio_internal_fifo_wake(RadioSession* radio) {
+    UNUSED(radio);
+    furi_hal_subghz_reset();
+    furi_hal_subghz_load_custom_preset(opensesame_fifo_preset_data);
+}
+
+// Simulated FIFO: drains one byte per 8 rounded bit periods. Each time
+// the level falls below the threshold the refill runs as the interrupt
+// would, FIFO_MODEL_LATENCY_US later, however late the worker polls.
+static uint32_t radio_simulated_fifo_drained(const RadioSession* radio, uint64_t time_ns) {
+    const FifoTx* fifo = &radio->fifo;
+    uint64_t drained = time_ns / (8ULL * fifo->period_ns);
+    if(drained > fifo->written) drained = fifo->written;
+    if(fifo->model_packet > 0 && drained > fifo->model_packet) drained = fifo->model_packet;
+    return (uint32_t)drained;
+}
+
+static uint8_t radio_simulated_fifo_level(RadioSession* radio) {
+    return radio->fifo.written - radio_simulated_fifo_drained(radio, radio->fifo.model_ns);
+}
+
+// A refill that finds the FIFO empty came too late: the radio has stopped
+static void radio_simulated_fifo_write(RadioSession* radio, const uint8_t* data, uint8_t size) {
+    UNUSED(data);
+    UNUSED(size);
+    FifoTx* fifo = &radio->fifo;
+    if(fifo->written > 0 && radio_simulated_fifo_drained(radio, fifo->model_ns) >= fifo->written) {
+        fifo->underflows++;
+        fifo->model_packet = fifo->written;
+    }
+}
+
+// The programmed length ends the packet. PKTLEN 0 is untested on hardware,
+// so it is flagged, not modelled: chunks are kept to CHUNK_BYTES_MAX so
+// that it is never written.
+static void radio_simulated_fifo_set_length(RadioSession* radio, uint8_t length) {
+    FifoTx* fifo = &radio->fifo;
+    if(length == 0) {
+        FURI_LOG_E("OpenSesame", "FIFO packet length 0 for %u bytes", fifo->size);
+        fifo->length_errors++;
+        fifo->model_packet = fifo->size;
+        return;
+    }
+    fifo->model_packet = length;
+}
+
+static void radio_simulated_fifo_catch_up(RadioSession* radio) {
+    FifoTx* fifo = &radio->fifo;
+    const uint64_t now_ns = (clock_now_us(radio->clock) - radio->start_us) * 1000;
+    while(fifo->written < fifo->size) {
+        // Byte whose departure takes the level below the threshold
+        const uint64_t crossing_ns =
+            (uint64_t)(fifo->written - CC1101_FIFO_THRESHOLD + 1) * 8 * fifo->period_ns;
+        const uint64_t refill_ns = crossing_ns + FIFO_MODEL_LATENCY_US * 1000ULL;
+        if(refill_ns > now_ns) break;
+        fifo->model_ns = refill_ns;
+        radio_fifo_refill(radio);
+    }
+}
+
+static bool radio_simulated_fifo_start_tx(RadioSession* radio) {
+    radio_fifo_start(radio);
+    radio->fifo.model_ns = 0;
+    radio->fifo.model_packet = 0;
+    radio_simulated_fifo_set_length(radio, (uint8_t)radio->fifo.size);
+    radio_fifo_refill(radio);
+    if(radio->fifo.model_packet != radio->fifo.size) {
+        FURI_LOG_W("OpenSesame", "FIFO packet length %lu for %u bytes",
+            radio->fifo.model_packet, radio->fifo.size);
+    }
+    return true;
+}
+
+static bool radio_simulated_fifo_is_tx_complete(RadioSession* radio) {
+    FifoTx* fifo = &radio->fifo;
+    radio_simulated_fifo_catch_up(radio);
+
+    const uint64_t now_ns = (clock_now_us(radio->clock) - radio->start_us) * 1000;
+    const uint32_t drained = radio_simulated_fifo_drained(radio, now_ns);
+    if(fifo->model_packet > 0 && drained >= fifo->model_packet) {
+        if(fifo->model_packet != fifo->size) {
+            FURI_LOG_W("OpenSesame", "FIFO packet ended at %lu of %u bytes",
+                fifo->model_packet, fifo->size);
+        }
+        return true;
+    }
+    // The radio stops on an empty FIFO before the packet's end
+    if(drained >= fifo->written && fifo->written < fifo->size) {
+        fifo->underflows++;
+        return true;
+    }
+    return false;
+}
+
+static const RadioBackend radio_backend_internal = {
+    .name = "CC1101 int",
+    .begin = radio_internal_begin,
+    .end = radio_internal_end,
+    .tune = radio_internal_tune,
+    .start_tx = radio_internal_start_tx,
+    .is_tx_complete = radio_internal_is_tx_complete,
+    .stop_tx = radio_internal_stop_tx,
+    .sleep = radio_internal_sleep,
+    .wake = radio_internal_wake,
+};
+
+static const RadioBackend radio_backend_external = {
+    .name = "CC1101 ext",
+    .begin = radio_external_begin,
+    .end = radio_external_end,
+    .tune = radio_external_tune,
+    .start_tx = radio_external_start_tx,
+    .is_tx_complete = radio_external_is_tx_complete,
+    .stop_tx = radio_external_stop_tx,
+    .sleep = radio_external_sleep,
+    .wake = radio_external_wake,
+};
+
+static const RadioBackend radio_backend_simulated = {
+    .name = "Simulated",
+    .begin = radio_simulated_begin,
+    .end = radio_simulated_end,
+    .tune = radio_simulated_tune,
+    .start_tx = radio_simulated_start_tx,
+    .is_tx_complete = radio_simulated_is_tx_complete,
+    .stop_tx = radio_simulated_stop_tx,
+    .sleep = radio_simulated_sleep,
+    .wake = radio_simulated_sleep,
+};
+
+static const RadioBackend radio_backend_internal_fifo = {
+    .name = "CC1101 int FIFO",
+    .begin = radio_internal_fifo_begin,
+    .end = radio_internal_fifo_end,
+    .tune = radio_internal_tune,
+    .start_tx = radio_internal_fifo_start_tx,
+    .is_tx_complete = radio_internal_fifo_is_tx_complete,
+    .stop_tx = radio_internal_fifo_stop_tx,
+    .sleep = radio_internal_sleep,
+    .wake = radio_internal_fifo_wake,
+    .fifo_level = radio_internal_fifo_level,
+    .fifo_write = radio_internal_fifo_write,
+};
+
+static const RadioBackend radio_backend_simulated_fifo = {
+    .name = "Simulated FIFO",
+    .begin = radio_simulated_begin,
+    .end = radio_simulated_end,
+    .tune = radio_simulated_tune,
+    .start_tx = radio_simulated_fifo_start_tx,
+    .is_tx_complete = radio_simulated_fifo_is_tx_complete,
+    .stop_tx = radio_simulated_stop_tx,
+    .sleep = radio_simulated_sleep,
+    .wake = radio_simulated_sleep,
+    .fifo_level = radio_simulated_fifo_level,
+    .fifo_write = radio_simulated_fifo_write,
+};
+
+// Dry runs keep the radio count and TX path of the chosen setup
+static RadioSetup opensesame_radio_setup_simulated(RadioSetup setup) {
+    switch(setup) {
+    case RadioSetupInternal:
+        return RadioSetupSimulated;
+    case RadioSetupInternalExternal:
+        return RadioSetupSimulatedDual;
+    case RadioSetupInternalFifo:
+        return RadioSetupSimulatedFifo;
+    default:
+        return setup;
+    }
+}
+
+// Radios are reset and loaded with the OOK preset once per run. Chunks
+// only retune when the frequency changes (e.g. between drift offsets).
+// A radio that cannot start is left out; the internal one always starts.
+static void opensesame_radios_begin(RadioSet* set, RadioSetup setup, Clock* clock) {
+    const RadioBackend* wanted[RADIO_MAX] = {NULL};
+    switch(setup) {
+    case RadioSetupInternalExternal:
+        wanted[0] = &radio_backend_internal;
+        wanted[1] = &radio_backend_external;
+        break;
+    case RadioSetupSimulated:
+        wanted[0] = &radio_backend_simulated;
+        break;
+    case RadioSetupSimulatedDual:
+        wanted[0] = &radio_backend_simulated;
+        wanted[1] = &radio_backend_simulated;
+        break;
+    case RadioSetupInternalFifo:
+        wanted[0] = &radio_backend_internal_fifo;
+        break;
+    case RadioSetupSimulatedFifo:
+        wanted[0] = &radio_backend_simulated_fifo;
+        break;
+    default:
+        wanted[0] = &radio_backend_internal;
+        break;
+    }
+
+    memset(set, 0, sizeof(RadioSet));
+    for(uint8_t i = 0; i < RADIO_MAX && wanted[i] != NULL; i++) {
+        RadioSession* radio = &set->radios[set->count];
+        radio->backend = wanted[i];
+        radio->clock = clock;
+        if(radio->backend->begin(radio)) {
+            set->count++;
+            FURI_LOG_I("OpenSesame", "Radio %u: %s", set->count, radio->backend->name);
+        } else {
+            FURI_LOG_W("OpenSesame", "%s not available, skipping", radio->backend->name);
+            memset(radio, 0, sizeof(RadioSession));
+        }
+    }
+}
+
+static void opensesame_radios_end(RadioSet* set) {
+    for(uint8_t i = 0; i < set->count; i++) {
+        RadioSession* radio = &set->radios[i];
+        if(radio->busy) {
+            radio->backend->stop_tx(radio);
+            radio->busy = false;
+        }
+        if(radio->backend->fifo_level != NULL) {
+            FURI_LOG_I(
+                "OpenSesame",
+                "%s: %lu FIFO refills, %lu underflows, %lu length errors",
+                radio->backend->name,
+                radio->fifo.refills,
+                radio->fifo.underflows,
+                radio->fifo.length_errors);
+        }
+        radio->backend->end(radio);
+        radio->frequency = 0;
+    }
+    set->count = 0;
+}
+
+// Starts a chunk without waiting for it; returns false if the radio refused it
+static bool opensesame_radio_start(
+    RadioSession* radio,
+    uint32_t frequency,
+    uint32_t bit_period_us,
+    uint8_t* buffer,
+    size_t size) {
+    if(radio == NULL || buffer == NULL || size == 0) return false;
+
+    radio->tx = (TxContext){
+        .buffer = buffer, .size = size, .position = 0, .bit_period_us = bit_period_us};
+
+    if(radio->asleep) {
+        radio->backend->wake(radio);
+        radio->asleep = false;
+        radio->frequency = 0;
+    }
+    if(radio->frequency != frequency) {
+        radio->backend->tune(radio, frequency);
+        radio->frequency = frequency;
+    }
+
+    radio->nominal_us = size * 8 * bit_period_us;
+    radio->start_us = clock_now_us(radio->clock);
+    radio->busy = radio->backend->start_tx(radio);
+    return radio->busy;
+}
+
+// Long-run mode: an idle radio is powered down until its next chunk
+static void opensesame_radio_sleep(RadioSession* radio) {
+    if(radio->busy || radio->asleep) return;
+    radio->backend->sleep(radio);
+    radio->asleep = true;
+}
+
+static uint32_t opensesame_radio_remaining_us(const RadioSession* radio) {
+    const uint64_t elapsed_us = clock_now_us(radio->clock) - radio->start_us;
+    return (elapsed_us < radio->nominal_us) ? radio->nominal_us - elapsed_us : 0;
+}
+
+// Waits until the radio's chunk is out and records its timing error.
+// Returns false if the worker was told to stop first.
+static bool opensesame_radio_finish(RadioSession* radio, JitterHistogram* jitter) {
+    // Merged runs can be long, so wait for the radio rather than the encoder
+    uint32_t elapsed_us = 0;
+    // A stop aborts the chunk mid-air: the sleeps wake on it
+    bool stopped = false;
+    while(!stopped && !radio->backend->is_tx_complete(radio)) {
+        elapsed_us = clock_now_us(radio->clock) - radio->start_us;
+        if(elapsed_us + TX_POLL_SPIN_US < radio->nominal_us) {
+            uint32_t sleep_ms = (radio->nominal_us - elapsed_us - TX_POLL_SPIN_US) / 1000;
+            stopped = clock_sleep_ms(radio->clock, CLAMP(sleep_ms, 10UL, 1UL));
+        } else {
+            clock_delay_us(radio->clock, 50);
+            stopped = worker_stop_requested();
+        }
+    }
+    if(stopped) {
+        radio->backend->stop_tx(radio);
+        radio->busy = false;
+        return false;
+    }
+    elapsed_us = clock_now_us(radio->clock) - radio->start_us;
+    radio->backend->stop_tx(radio);
+    radio->busy = false;
+    radio->elapsed_us = elapsed_us;
+
+    if(jitter != NULL) {
+        jitter_histogram_record(
+            jitter,
+            (elapsed_us > radio->nominal_us) ? elapsed_us - radio->nominal_us :
+                                               radio->nominal_us - elapsed_us);
+    }
+    return true;
+}
+
+// --- Helper for de Bruijn ---
+static size_t opensesame_append_digit_pattern(
+    uint8_t digit,
+    const OpenSesameTarget* target,
+    uint8_t* buffer,
+    size_t bit_offset) {
+    if(target == NULL || buffer == NULL) return bit_offset;
+    
+    uint32_t bit_pattern = opensesame_digit_pattern(target, digit);
+
+    size_t current_bit_index = bit_offset;
+    for(uint8_t j = 0; j < target->length; j++) {
+        bool bit_is_set = (bit_pattern >> (target->length - 1 - j)) & 1;
+        if(bit_is_set) {
+            size_t byte_index = current_bit_index / 8;
+            size_t bit_in_byte_index = 7 - (current_bit_index % 8);
+            buffer[byte_index] |= (1 << bit_in_byte_index);
+        }
+        current_bit_index++;
+    }
+    return current_bit_index;
+}
+
+// --- Duty-Cycle Governor ---
+static uint8_t duty_band_for_frequency(uint32_t frequency) {
+    for(uint8_t i = 0; i < DUTY_BAND_COUNT; i++) {
+        if(frequency >= duty_bands[i].freq_min && frequency <= duty_bands[i].freq_max) {
+            return i;
+        }
+    }
+    return DUTY_BAND_NONE;
+}
+
+static uint32_t duty_band_capacity_us(uint8_t band) {
+    // permille of every millisecond is exactly that many microseconds
+    return duty_bands[band].duty_permille * DUTY_WINDOW_MS;
+}
+
+static void airtime_governor_init(AirtimeGovernor* governor, Clock* clock) {
+    memset(governor->ledgers, 0, sizeof(governor->ledgers));
+    governor->clock = clock;
+    uint32_t now = clock_now_ms(clock);
+    for(uint8_t i = 0; i < DUTY_BAND_COUNT; i++) {
+        governor->ledgers[i].head_tick = now;
+    }
+}
+
+// Moves the ledger on to the current minute, dropping minutes that left the window
+static AirtimeLedger* airtime_governor_advance(AirtimeGovernor* governor, uint8_t band) {
+    AirtimeLedger* ledger = &governor->ledgers[band];
+    uint32_t now = clock_now_ms(governor->clock);
+    if(now - ledger->head_tick >= DUTY_SLOTS * DUTY_SLOT_MS) {
+        memset(ledger->slot_us, 0, sizeof(ledger->slot_us));
+        ledger->window_us = 0;
+        ledger->head_tick = now;
+        return ledger;
+    }
+    while(now - ledger->head_tick >= DUTY_SLOT_MS) {
+        ledger->head = (ledger->head + 1) % DUTY_SLOTS;
+        ledger->window_us -= ledger->slot_us[ledger->head];
+        ledger->slot_us[ledger->head] = 0;
+        ledger->head_tick += DUTY_SLOT_MS;
+    }
+    return ledger;
+}
+
+// Airtime 'band' can still take without any one-hour window going over,
+// as of the ledger's current minute
+static uint32_t airtime_governor_available_us(const AirtimeGovernor* governor, uint8_t band) {
+    const AirtimeLedger* ledger = &governor->ledgers[band];
+    const uint32_t capacity = duty_band_capacity_us(band);
+    return (ledger->window_us < capacity) ? capacity - ledger->window_us : 0;
+}
+
+// Milliseconds until 'airtime_us' may be transmitted on 'band' (0 = now):
+// the oldest minutes leave the window until enough airtime is freed
+static uint32_t airtime_governor_wait_ms(AirtimeGovernor* governor, uint8_t band, uint32_t airtime_us) {
+    if(band == DUTY_BAND_NONE) return 0;
+
+    const AirtimeLedger* ledger = airtime_governor_advance(governor, band);
+    const uint32_t available_us = airtime_governor_available_us(governor, band);
+    if(available_us >= airtime_us) return 0;
+
+    const uint32_t into_slot_ms = clock_now_ms(governor->clock) - ledger->head_tick;
+    uint32_t freed_us = available_us;
+    for(int age = DUTY_SLOTS - 1; age >= 0; age--) {
+        freed_us += ledger->slot_us[(ledger->head + DUTY_SLOTS - age) % DUTY_SLOTS];
+        if(freed_us >= airtime_us) {
+            return (DUTY_SLOTS - age) * DUTY_SLOT_MS - into_slot_ms;
+        }
+    }
+    return DUTY_SLOTS * DUTY_SLOT_MS; // More than a whole hour allows
+}
+
+// Refused if it would take a one-hour window over the band's allowance,
+// however the caller sized it: the caller waits and charges again
+static bool airtime_governor_charge(AirtimeGovernor* governor, uint8_t band, uint32_t airtime_us) {
+    if(band == DUTY_BAND_NONE) return true;
+
+    AirtimeLedger* ledger = airtime_governor_advance(governor, band);
+    if(airtime_us > airtime_governor_available_us(governor, band)) return false;
+    ledger->slot_us[ledger->head] += airtime_us;
+    ledger->window_us += airtime_us;
+    return true;
+}
+
+// --- Run History ---
+// Aggregates are kept in RAM once loaded. Loading reads the index, then
+// folds in only the history records appended after it was written, so the
+// whole history is read again only when the index is missing or stale.
+static int32_t history_index_of(const RunHistory* history, uint8_t target, uint8_t mode) {
+    for(uint16_t i = 0; i < history->count; i++) {
+        if(history->entries[i].target == target && history->entries[i].mode == mode) return i;
+    }
+    return -1;
+}
+
+static HistoryAggregate* history_find_or_add(RunHistory* history, uint8_t target, uint8_t mode) {
+    const int32_t index = history_index_of(history, target, mode);
+    if(index >= 0) return &history->entries[index];
+    if(history->count >= HISTORY_AGGREGATES_MAX) return NULL;
+
+    HistoryAggregate* entries =
+        realloc(history->entries, (history->count + 1) * sizeof(HistoryAggregate));
+    if(entries == NULL) return NULL;
+    history->entries = entries;
+
+    HistoryAggregate* entry = &entries[history->count++];
+    memset(entry, 0, sizeof(HistoryAggregate));
+    entry->target = target;
+    entry->mode = mode;
+    return entry;
+}
+
+static void history_fold(RunHistory* history, const HistoryRecord* record) {
+    if(record->type != HistoryRecordStep && record->type != HistoryRecordHit) return;
+
+    HistoryAggregate* entry = history_find_or_add(history, record->target, record->mode);
+    if(entry == NULL) return;
+    entry->last_run = MAX(entry->last_run, record->run);
+
+    if(record->type == HistoryRecordStep) {
+        entry->runs++;
+        if(record->status != 0) entry->completed++;
+        entry->airtime_ms += record->airtime_ms;
+        entry->wall_ms += record->wall_ms;
+        return;
+    }
+
+    // Newest hit first, each code once, the oldest dropped when full
+    uint8_t i = 0;
+    while(i < entry->hit_count && entry->hits[i] != record->codes) i++;
+    if(i == entry->hit_count && entry->hit_count < HISTORY_HITS_MAX) entry->hit_count++;
+    memmove(&entry->hits[1], &entry->hits[0], MIN(i, HISTORY_HITS_MAX - 1) * sizeof(uint32_t));
+    entry->hits[0] = record->codes;
+}
+
+static bool history_header_valid(const HistoryHeader* header) {
+    return header->magic == HISTORY_MAGIC && header->version == HISTORY_VERSION &&
+           header->record_size == sizeof(HistoryRecord);
+}
+
+static void history_save_index(RunHistory* history, Storage* storage) {
+    const HistoryIndexHeader header = {
+        .magic = HISTORY_INDEX_MAGIC,
+        .version = HISTORY_VERSION,
+        .entry_size = sizeof(HistoryAggregate),
+        .history_created = history->history_created,
+        .history_bytes = history->history_bytes,
+        .count = history->count,
+    };
+    const size_t size = history->count * sizeof(HistoryAggregate);
+
+    // A short index fails its read and is rebuilt from the history
+    File* file = storage_file_alloc(storage);
+    if(storage_file_open(file, HISTORY_INDEX_PATH, FSAM_WRITE, FSOM_CREATE_ALWAYS) &&
+       storage_file_write(file, &header, sizeof(header)) == sizeof(header) && size > 0) {
+        storage_file_write(file, history->entries, size);
+    }
+    storage_file_close(file);
+    storage_file_free(file);
+}
+
+static bool history_load_index(RunHistory* history, File* file) {
+    HistoryIndexHeader header;
+    if(!storage_file_open(file, HISTORY_INDEX_PATH, FSAM_READ, FSOM_OPEN_EXISTING) ||
+       storage_file_read(file, &header, sizeof(header)) != sizeof(header) ||
+       header.magic != HISTORY_INDEX_MAGIC || header.version != HISTORY_VERSION ||
+       header.entry_size != sizeof(HistoryAggregate) || header.count > HISTORY_AGGREGATES_MAX) {
+        return false;
+    }
+
+    const size_t size = header.count * sizeof(HistoryAggregate);
+    if(size > 0) {
+        HistoryAggregate* entries = realloc(history->entries, size);
+        if(entries == NULL) return false;
+        history->entries = entries;
+        if(storage_file_read(file, entries, size) != size) return false;
+    }
+    history->count = header.count;
+    history->history_created = header.history_created;
+    history->history_bytes = header.history_bytes;
+    return true;
+}
+
+// Caller holds the mutex
+static void history_load(RunHistory* history) {
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+    File* file = storage_file_alloc(storage);
+
+    bool changed = !history_load_index(history, file);
+    storage_file_close(file);
+    if(changed) {
+        history->count = 0;
+        history->history_created = 0;
+        history->history_bytes = 0;
+    }
+
+    HistoryHeader header;
+    uint64_t size = 0;
+    if(storage_file_open(file, HISTORY_PATH, FSAM_READ, FSOM_OPEN_EXISTING) &&
+       storage_file_read(file, &header, sizeof(header)) == sizeof(header) &&
+       history_header_valid(&header)) {
+        size = storage_file_size(file);
+    }
+
+    // An index written for another history file, or covering more than
+    // this one holds, is folded again from the first record
+    if(size == 0) {
+        changed |= (history->count > 0 || history->history_bytes > 0);
+        history->count = 0;
+        history->history_created = 0;
+        history->history_bytes = 0;
+    } else if(header.created != history->history_created ||
+              history->history_bytes < sizeof(HistoryHeader) || history->history_bytes > size) {
+        changed = true;
+        history->count = 0;
+        history->history_created = header.created;
+        history->history_bytes = sizeof(HistoryHeader);
+    }
+
+    HistoryRecord* records = malloc(HISTORY_READ_RECORDS * sizeof(HistoryRecord));
+    if(size > history->history_bytes && records != NULL &&
+       storage_file_seek(file, history->history_bytes, true)) {
+        size_t read;
+        do {
+            read = storage_file_read(file, records, HISTORY_READ_RECORDS * sizeof(HistoryRecord));
+            const size_t count = read / sizeof(HistoryRecord); // A torn record is left out
+            for(size_t i = 0; i < count; i++) {
+                history_fold(history, &records[i]);
+            }
+            history->history_bytes += count * sizeof(HistoryRecord);
+            changed |= (count > 0);
+        } while(read == HISTORY_READ_RECORDS * sizeof(HistoryRecord));
+    }
+    free(records);
+    storage_file_close(file);
+    storage_file_free(file);
+
+    if(changed) history_save_index(history, storage);
+    furi_record_close(RECORD_STORAGE);
+    history->loaded = true;
+}
+
+static void history_ensure_loaded(RunHistory* history) {
+    furi_mutex_acquire(history->mutex, FuriWaitForever);
+    if(!history->loaded) history_load(history);
+    furi_mutex_release(history->mutex);
+}
+
+// False until the history is loaded or while the target has no records
+static bool history_lookup(
+    const RunHistory* history,
+    uint8_t target,
+    uint8_t mode,
+    HistoryAggregate* out) {
+    furi_mutex_acquire(history->mutex, FuriWaitForever);
+    const int32_t index = history->loaded ? history_index_of(history, target, mode) : -1;
+    if(index >= 0) *out = history->entries[index];
+    furi_mutex_release(history->mutex);
+    return index >= 0;
+}
+
+// Appends whole records and folds them in. A write torn by power loss
+// leaves part of a record at the end, which the next append writes over.
+static bool history_append(RunHistory* history, const HistoryRecord* records, uint8_t count) {
+    furi_mutex_acquire(history->mutex, FuriWaitForever);
+    if(!history->loaded) history_load(history);
+
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+    File* file = storage_file_alloc(storage);
+    HistoryHeader header;
+    bool ok = storage_file_open(file, HISTORY_PATH, FSAM_READ_WRITE, FSOM_OPEN_ALWAYS);
+    uint64_t size = ok ? storage_file_size(file) : 0;
+    if(ok && (size < sizeof(header) ||
+              storage_file_read(file, &header, sizeof(header)) != sizeof(header) ||
+              !history_header_valid(&header))) {
+        // New or unreadable: start the history over
+        memset(&header, 0, sizeof(header));
+        header.magic = HISTORY_MAGIC;
+        header.version = HISTORY_VERSION;
+        header.record_size = sizeof(HistoryRecord);
+        header.created = furi_hal_rtc_get_timestamp();
+        ok = storage_file_seek(file, 0, true) && storage_file_truncate(file) &&
+             storage_file_write(file, &header, sizeof(header)) == sizeof(header);
+        size = sizeof(header);
+        history->count = 0;
+        history->history_created = header.created;
+        history->history_bytes = sizeof(header);
+    }
+
+    const uint32_t end = sizeof(header) +
+                         (size - sizeof(header)) / sizeof(HistoryRecord) * sizeof(HistoryRecord);
+    const size_t bytes = count * sizeof(HistoryRecord);
+    ok = ok && storage_file_seek(file, end, true) &&
+         storage_file_write(file, records, bytes) == bytes;
+    storage_file_close(file);
+    storage_file_free(file);
+
+    if(ok && end == history->history_bytes) {
+        for(uint8_t i = 0; i < count; i++) {
+            history_fold(history, &records[i]);
+        }
+        history->history_bytes = end + bytes;
+        history_save_index(history, storage);
+    } else {
+        history->loaded = false; // Fold whatever reached the file on the next load
+    }
+    furi_record_close(RECORD_STORAGE);
+    furi_mutex_release(history->mutex);
+    return ok;
+}
+
+// Worker only: keeps the measurements of a step that ran for the run's
+// records. The estimate and options are filled in when the run ends.
+static void history_record_step(OpenSesameApp* app, const AttackStep* step) {
+    RunHistory* history = &app->history;
+    if(history->run_steps == NULL || history->run_step_count >= history->run_step_max) return;
+
+    uint32_t codes = step->sent;
+    bool done = step->sent >= step->num_codes;
+    if(app->attack_mode == AttackModeDeBruijn) {
+        codes = (step->sent >= step->n - 1u) ? step->sent - (step->n - 1u) : 0;
+        done = step->sent >= step->total_digits;
+    }
+
+    HistoryRecord* record = &history->run_steps[history->run_step_count++];
+    memset(record, 0, sizeof(HistoryRecord));
+    record->type = HistoryRecordStep;
+    record->mode = app->attack_mode;
+    record->target = step->target_idx;
+    record->status = done;
+    record->run = history->run_id;
+    record->codes = codes;
+    record->total = step->num_codes;
+    record->airtime_ms = (uint32_t)(step->airtime_us / 1000);
+    record->wall_ms = clock_now_ms(app->clock) - step->start_ms;
+    record->radios = app->radio_count;
+    record->strategy = step->strategy;
+}
+
+// GUI and CLI: the operator saw the receiver open, so the newest code of
+// the chunk a radio started last is kept as a hit, with that chunk's
+// target. Writing it to SD is left to the worker, so input handling never
+// waits on SD. Refused while an earlier hit is still waiting for it. Dry
+// runs send nothing to hit.
+static bool history_mark_hit(OpenSesameApp* app, uint32_t* code, uint8_t* target) {
+    RunHistory* history = &app->history;
+    if(!app->is_attacking || app->clock == &app->virtual_clock || app->stop_bench) {
+        return false;
+    }
+
+    OnAirChunk on_air;
+    on_air_get(app, &on_air);
+    if(on_air.codes == 0) return false;
+
+    uint8_t slot = HitSlotFree;
+    if(!__atomic_compare_exchange_n(
+           &history->hit_slot, &slot, HitSlotWriting, false, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+        return false;
+    }
+    history->hit = (HistoryRecord){
+        .type = HistoryRecordHit,
+        .mode = app->attack_mode,
+        .target = on_air.target,
+        .run = history->run_id,
+        .codes = on_air.last_code,
+        .radios = app->radio_count,
+    };
+    __atomic_store_n(&history->hit_slot, HitSlotReady, __ATOMIC_RELEASE);
+
+    history->hit_code = on_air.last_code;
+    history->hit_marked = true;
+    *code = on_air.last_code;
+    *target = on_air.target;
+    return true;
+}
+
+// Worker only: appends a hit the GUI or CLI marked
+static void history_flush_hit(RunHistory* history) {
+    if(__atomic_load_n(&history->hit_slot, __ATOMIC_ACQUIRE) != HitSlotReady) return;
+    const HistoryRecord record = history->hit;
+    __atomic_store_n(&history->hit_slot, HitSlotFree, __ATOMIC_RELEASE);
+    if(!history_append(history, &record, 1)) {
+        FURI_LOG_W("OpenSesame", "Hit not written");
+    }
+}
+
+// --- Attack Plan ---
+static bool opensesame_is_meta_target(uint8_t target_idx) {
+    return target_idx == 4 || target_idx == 5 || target_idx == 6;
+}
+
+static bool opensesame_target_fits_pow(const OpenSesameTarget* target) {
+    return target->radix >= 2 && target->radix <= DIGIT_RADIX_MAX &&
+           target->bits <= CODE_DIGITS_MAX &&
+           opensesame_target_code_count(target, AttackModeCompatibility) <= UINT32_MAX;
+}
+
+// Any size the digit counters can hold: a step that cannot afford the
+// sequence in RAM streams it instead
+static bool opensesame_target_fits_debruijn(const OpenSesameTarget* target) {
+    return opensesame_target_fits_pow(target) &&
+           opensesame_target_code_count(target, AttackModeDeBruijn) <= UINT32_MAX - CODE_DIGITS_MAX;
+}
+
+static void opensesame_plan_build(OpenSesameApp* app, AttackPlan* plan) {
+    const bool is_meta = opensesame_is_meta_target(app->current_target_index);
+    uint8_t target_start = 0;
+    uint8_t target_end = 0;
+
+    if(app->current_target_index == 5) {
+        target_start = 0;
+        target_end = 67; // Index of last generic target
+    } else if(app->current_target_index == 4) {
+        target_start = 0;
+        target_end = 3; // The 4 known models
+    } else if(app->current_target_index == 6) {
+        target_start = 68; // Index of first European target
+        target_end = opensesame_total_target_count - 1; // 81
+    } else { // Single target
+        target_start = app->current_target_index;
+        target_end = app->current_target_index;
+    }
+
+    plan->count = 0;
+    for(uint8_t target_idx = target_start; target_idx <= target_end; target_idx++) {
+        if(opensesame_is_meta_target(target_idx)) continue; // Skip meta-targets
+
+        const OpenSesameTarget* t = &opensesame_targets[target_idx];
+        if(!opensesame_target_fits_pow(t)) {
+            FURI_LOG_W("OpenSesame", "Target %s too large, skipping", t->name);
+            continue;
+        }
+        // A single target stays in the plan so the run can report the failure
+        if(is_meta && app->attack_mode == AttackModeDeBruijn &&
+           !opensesame_target_fits_debruijn(t)) {
+            FURI_LOG_W("OpenSesame", "Target '%s' (%d bits) too large for de Bruijn, skipping.",
+                t->name, t->bits);
+            continue;
+        }
+        plan->target_idx[plan->count++] = target_idx;
+    }
+
+    // Targets with recorded hits go first, the rest keep table order
+    uint8_t front = 0;
+    for(uint8_t i = 0; is_meta && i < plan->count; i++) {
+        HistoryAggregate aggregate;
+        const uint8_t target_idx = plan->target_idx[i];
+        if(history_lookup(&app->history, target_idx, app->attack_mode, &aggregate) &&
+           aggregate.hit_count > 0) {
+            memmove(&plan->target_idx[front + 1], &plan->target_idx[front], i - front);
+            plan->target_idx[front++] = target_idx;
+        }
+    }
+}
+
+// --- de Bruijn Generator ---
+// Fredricksen-Kessler-Maiorana: the Lyndon words whose length divides n,
+// in lexicographic order, concatenate to the smallest de Bruijn sequence
+// for any alphabet size. Digits come out one at a time from O(n) state, so
+// nothing of size k^n is needed besides the output itself.
+static void debruijn_stream_init(DeBruijnStream* stream, uint8_t k, uint8_t n) {
+    memset(stream, 0, sizeof(DeBruijnStream));
+    stream->k = k;
+    stream->n = n;
+    stream->length = 1; // "0" is the first Lyndon word
+    stream->position = 1;
+}
+
+// Next digit of the sequence; it repeats after k^n digits
+static uint8_t debruijn_stream_next(DeBruijnStream* stream) {
+    while(stream->position > stream->length) {
+        // Successor prenecklace: bump the last digit below k - 1 and repeat
+        // the prefix; the all-(k-1) word is the last one, then start over
+        uint8_t i = stream->n;
+        while(i > 0 && stream->word[i] == stream->k - 1) i--;
+        if(i == 0) {
+            debruijn_stream_init(stream, stream->k, stream->n);
+            break;
+        }
+        stream->word[i]++;
+        for(uint8_t j = i + 1; j <= stream->n; j++) {
+            stream->word[j] = stream->word[j - i];
+        }
+        if(stream->n % i == 0) {
+            stream->length = i;
+            stream->position = 1;
+        }
+    }
+    return stream->word[stream->position++];
+}
+
+static uint8_t* opensesame_debruijn_generate_packed(
+    uint8_t k,
+    uint8_t n,
+    uint32_t num_codes,
+    uint32_t yield_digits) {
+    uint8_t* packed = malloc(PACKED_SEQUENCE_BYTES(num_codes));
+    if(packed == NULL) {
+        FURI_LOG_E("OpenSesame", "Failed to allocate sequence");
+        return NULL;
+    }
+    memset(packed, 0, PACKED_SEQUENCE_BYTES(num_codes));
+
+    DeBruijnStream stream;
+    debruijn_stream_init(&stream, k, n);
+    for(uint32_t i = 0; i < num_codes; i++) {
+        opensesame_packed_set_digit(packed, i, debruijn_stream_next(&stream));
+
+        if(i % yield_digits == yield_digits - 1) {
+            furi_delay_ms(1);
+            if(worker_stop_requested()) {
+                free(packed);
+                return NULL;
+            }
+        }
+    }
+    return packed;
+}
+
+// --- Sequence Packs ---
+// Generated sequences are also written to SD, so a cache miss in a later
+// session streams the pack instead of generating the sequence and holding
+// it in RAM. Every block is checked against its CRC as it is loaded. A
+// damaged block is rebuilt from the generator when the pack names one
+// this build has, otherwise its digits are skipped; either way the pack
+// is removed when the step ends and written again on the next miss.
+// Blocks have a fixed size, so any digit is one seek away.
+struct PackReader {
+    OpenSesameApp* app; // For events and session counters
+    Storage* storage;
+    File* file;
+    PackHeader header;
+    uint32_t block; // Held in data, UINT32_MAX = none
+    uint8_t raw[PACK_BLOCK_BYTES + sizeof(uint32_t)]; // Block as read, then its CRC
+    uint8_t data[PACK_BLOCK_BYTES]; // Block digits, 2 bits each
+    uint8_t* state; // PackBlockState per block
+    uint16_t damaged; // Blocks repaired or skipped
+};
+
+// Standard CRC-32 (zlib), as furi_hal_crc configures the hardware unit.
+// Only used while another thread holds the unit.
+static uint32_t pack_crc_soft(const uint8_t* data, size_t size) {
+    uint32_t crc = 0xFFFFFFFFUL;
+    for(size_t i = 0; i < size; i++) {
+        crc ^= data[i];
+        for(uint8_t b = 0; b < 8; b++) {
+            crc = (crc >> 1) ^ (0xEDB88320UL & (0U - (crc & 1)));
+        }
+    }
+    return ~crc;
+}
+
+// A block takes a few microseconds on the CRC unit, against milliseconds
+// to read it from SD
+static uint32_t pack_crc(const void* data, size_t size) {
+    if(!furi_hal_crc_acquire(0)) return pack_crc_soft(data, size);
+    furi_hal_crc_reset();
+    const uint32_t crc = furi_hal_crc_feed((void*)data, size);
+    furi_hal_crc_release();
+    return crc;
+}
+
+static void pack_path(char* path, size_t size, uint8_t k, uint8_t n) {
+    snprintf(path, size, PACK_PATH_FORMAT, k, n);
+}
+
+// Most base-k digits a byte can hold
+static uint8_t pack_digits_per_byte(uint8_t k) {
+    uint8_t count = 0;
+    for(uint32_t span = k; span <= 256; span *= k) count++;
+    return count;
+}
+
+// Identifies a prior set, so a stored rotation is only reused for the same one
+static uint32_t pack_prior_key(const CodeOrder* order) {
+    return pack_crc(order->sorted, order->prior_count * sizeof(uint32_t)) ^ order->prior_count;
+}
+
+static void pack_header_init(
+    PackHeader* header,
+    uint8_t k,
+    uint8_t n,
+    uint32_t digits,
+    uint32_t prior_offset,
+    uint32_t prior_key) {
+    memset(header, 0, sizeof(PackHeader));
+    header->magic = PACK_MAGIC;
+    header->version = PACK_VERSION;
+    header->k = k;
+    header->n = n;
+    header->generator = PackGeneratorFkm;
+    header->digits_per_byte = pack_digits_per_byte(k);
+    header->digits = digits;
+    header->block_digits = PACK_BLOCK_DIGITS;
+    header->block_count = (digits + PACK_BLOCK_DIGITS - 1) / PACK_BLOCK_DIGITS;
+    header->block_bytes = (PACK_BLOCK_DIGITS + header->digits_per_byte - 1) / header->digits_per_byte;
+    header->index_entry_size = sizeof(PackIndexEntry);
+    header->prior_offset = prior_offset;
+    header->prior_key = prior_key;
+    header->crc = pack_crc(header, sizeof(PackHeader) - sizeof(header->crc));
+}
+
+static uint32_t pack_block_position(const PackHeader* header, uint32_t block) {
+    return sizeof(PackHeader) + header->block_count * sizeof(PackIndexEntry) +
+           block * (header->block_bytes + sizeof(uint32_t));
+}
+
+// Digits [first, first + count) of a RAM sequence as one block of base-k bytes
+static void pack_encode_block(
+    const PackHeader* header,
+    const uint8_t* packed,
+    uint32_t first,
+    uint32_t count,
+    uint8_t* out) {
+    for(uint16_t b = 0; b < header->block_bytes; b++) {
+        uint8_t value = 0;
+        for(uint8_t j = header->digits_per_byte; j-- > 0;) {
+            const uint32_t i = b * header->digits_per_byte + j;
+            const uint8_t digit = (i < count) ? opensesame_packed_digit(packed, first + i) : 0;
+            value = value * header->k + digit;
+        }
+        out[b] = value;
+    }
+}
+
+static void pack_decode_block(const PackHeader* header, const uint8_t* raw, uint8_t* data) {
+    memset(data, 0, PACK_BLOCK_BYTES);
+    uint32_t i = 0;
+    for(uint16_t b = 0; b < header->block_bytes; b++) {
+        uint8_t value = raw[b];
+        for(uint8_t j = 0; j < header->digits_per_byte && i < header->block_digits; j++) {
+            opensesame_packed_set_digit(data, i++, value % header->k);
+            value /= header->k;
+        }
+    }
+}
+
+static bool pack_storage_ready(void) {
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+    const bool ready = storage_sd_status(storage) == FSE_OK;
+    furi_record_close(RECORD_STORAGE);
+    return ready;
+}
+
+// A failed write leaves no pack behind. The rotation computed for 'order'
+// is stored, so opening the pack does not scan it again.
+static bool pack_write(
+    OpenSesameApp* app,
+    uint8_t k,
+    uint8_t n,
+    const uint8_t* packed,
+    uint32_t digits,
+    const CodeOrder* order,
+    uint32_t prior_offset) {
+    char path[PACK_PATH_SIZE];
+    pack_path(path, sizeof(path), k, n);
+    PackHeader header;
+    pack_header_init(&header, k, n, digits, prior_offset, pack_prior_key(order));
+
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+    storage_simply_mkdir(storage, PACK_DIR);
+    File* file = storage_file_alloc(storage);
+    bool ok = storage_file_open(file, path, FSAM_WRITE, FSOM_CREATE_ALWAYS) &&
+              storage_file_write(file, &header, sizeof(header)) == sizeof(header);
+
+    // The generator is replayed alongside to record its state at each block
+    // A stop between blocks drops the partial pack
+    DeBruijnStream stream;
+    debruijn_stream_init(&stream, k, n);
+    for(uint32_t b = 0; ok && b < header.block_count; b++) {
+        if(worker_stop_requested()) {
+            ok = false;
+            break;
+        }
+        const uint32_t first = b * PACK_BLOCK_DIGITS;
+        PackIndexEntry entry;
+        memset(&entry, 0, sizeof(entry));
+        entry.first_digit = first;
+        entry.length = stream.length;
+        entry.position = stream.position;
+        for(uint8_t i = 1; i <= n; i++) {
+            opensesame_packed_set_digit(entry.word, i - 1, stream.word[i]);
+        }
+        entry.crc = pack_crc(&entry, sizeof(entry) - sizeof(entry.crc));
+        ok = storage_file_write(file, &entry, sizeof(entry)) == sizeof(entry);
+
+        for(uint32_t i = first; i < MIN(first + PACK_BLOCK_DIGITS, digits); i++) {
+            debruijn_stream_next(&stream);
+        }
+    }
+
+    uint8_t block[PACK_BLOCK_BYTES + sizeof(uint32_t)];
+    const size_t stride = header.block_bytes + sizeof(uint32_t);
+    for(uint32_t b = 0; ok && b < header.block_count; b++) {
+        if(worker_stop_requested()) {
+            ok = false;
+            break;
+        }
+        const uint32_t first = b * PACK_BLOCK_DIGITS;
+        const uint32_t count = MIN(digits - first, (uint32_t)PACK_BLOCK_DIGITS);
+        pack_encode_block(&header, packed, first, count, block);
+        const uint32_t crc = pack_crc(block, header.block_bytes);
+        memcpy(block + header.block_bytes, &crc, sizeof(crc));
+        ok = storage_file_write(file, block, stride) == stride;
+    }
+
+    storage_file_close(file);
+    storage_file_free(file);
+    if(!ok) storage_common_remove(storage, path);
+    furi_record_close(RECORD_STORAGE);
+    OPENSESAME_EVENT(app, EventPackWrite, k, n, ok);
+    return ok;
+}
+
+static void pack_reader_close(PackReader* reader) {
+    storage_file_close(reader->file);
+    storage_file_free(reader->file);
+    if(reader->damaged > 0) {
+        char path[PACK_PATH_SIZE];
+        pack_path(path, sizeof(path), reader->header.k, reader->header.n);
+        storage_common_remove(reader->storage, path);
+    }
+    furi_record_close(RECORD_STORAGE);
+    free(reader->state);
+    free(reader);
+}
+
+// NULL unless a pack for exactly this sequence is on SD with a valid header
+static PackReader* pack_reader_open(OpenSesameApp* app, uint8_t k, uint8_t n, uint32_t digits) {
+    if(!pack_storage_ready()) return NULL;
+
+    char path[PACK_PATH_SIZE];
+    pack_path(path, sizeof(path), k, n);
+
+    PackReader* reader = malloc(sizeof(PackReader));
+    if(reader == NULL) return NULL;
+    memset(reader, 0, sizeof(PackReader));
+    reader->app = app;
+    reader->block = UINT32_MAX;
+
+    // Held until pack_reader_close frees the file
+    reader->storage = furi_record_open(RECORD_STORAGE);
+    reader->file = storage_file_alloc(reader->storage);
+
+    // Same fields give the same CRC, so a damaged header does not match.
+    // Older versions are written again on the next miss. The stored
+    // rotation can be any, so it is taken from the pack.
+    PackHeader* header = &reader->header;
+    bool ok = storage_file_open(reader->file, path, FSAM_READ, FSOM_OPEN_EXISTING) &&
+              storage_file_read(reader->file, header, sizeof(PackHeader)) == sizeof(PackHeader);
+    if(ok) {
+        PackHeader expected;
+        pack_header_init(&expected, k, n, digits, header->prior_offset, header->prior_key);
+        ok = memcmp(header, &expected, sizeof(PackHeader)) == 0;
+    }
+    if(ok) {
+        reader->state = malloc(header->block_count);
+        ok = reader->state != NULL;
+    }
+    if(!ok) {
+        pack_reader_close(reader);
+        return NULL;
+    }
+    memset(reader->state, PackBlockUnchecked, header->block_count);
+    return reader;
+}
+
+static bool pack_available(OpenSesameApp* app, uint8_t k, uint8_t n, uint32_t digits) {
+    PackReader* reader = pack_reader_open(app, k, n, digits);
+    if(reader == NULL) return false;
+    pack_reader_close(reader);
+    return true;
+}
+
+// Restarts the generator from the block's index entry. If that is damaged
+// too, the generator is replayed from the first digit instead.
+static void pack_reader_rebuild(PackReader* reader, uint32_t block) {
+    const PackHeader* header = &reader->header;
+    DeBruijnStream stream;
+    debruijn_stream_init(&stream, header->k, header->n);
+    const uint32_t first = block * PACK_BLOCK_DIGITS;
+
+    PackIndexEntry entry;
+    const uint32_t position = sizeof(PackHeader) + block * sizeof(PackIndexEntry);
+    if(storage_file_seek(reader->file, position, true) &&
+       storage_file_read(reader->file, &entry, sizeof(entry)) == sizeof(entry) &&
+       entry.crc == pack_crc(&entry, sizeof(entry) - sizeof(entry.crc)) &&
+       entry.first_digit == first && entry.length >= 1 && entry.length <= header->n) {
+        stream.length = entry.length;
+        stream.position = entry.position;
+        for(uint8_t i = 1; i <= header->n; i++) {
+            stream.word[i] = opensesame_packed_digit(entry.word, i - 1);
+        }
+    } else {
+        for(uint32_t i = 0; i < first; i++) {
+            // Stopped: the block is never sent
+            if(i % STOP_CHECK_DIGITS == 0 && worker_stop_requested()) return;
+            debruijn_stream_next(&stream);
+        }
+    }
+
+    memset(reader->data, 0, PACK_BLOCK_BYTES);
+    const uint32_t count = MIN(reader->header.digits - first, (uint32_t)PACK_BLOCK_DIGITS);
+    for(uint32_t i = 0; i < count; i++) {
+        opensesame_packed_set_digit(reader->data, i, debruijn_stream_next(&stream));
+    }
+}
+
+// Loads and checks the block; false if it is damaged and had to be skipped
+static bool pack_reader_load(PackReader* reader, uint32_t block) {
+    if(block == reader->block) return true;
+    if(reader->state[block] == PackBlockSkipped) return false;
+
+    const PackHeader* header = &reader->header;
+    const size_t stride = header->block_bytes + sizeof(uint32_t);
+    bool good = storage_file_seek(reader->file, pack_block_position(header, block), true) &&
+                storage_file_read(reader->file, reader->raw, stride) == stride;
+    reader->app->sequence_cache.pack_bytes_read += stride;
+    if(good) {
+        uint32_t crc;
+        memcpy(&crc, reader->raw + header->block_bytes, sizeof(crc));
+        good = pack_crc(reader->raw, header->block_bytes) == crc;
+    }
+    if(good) {
+        pack_decode_block(header, reader->raw, reader->data);
+        if(reader->state[block] == PackBlockUnchecked) reader->state[block] = PackBlockGood;
+        reader->block = block;
+        return true;
+    }
+
+    PackBlockState outcome = PackBlockSkipped;
+    if(reader->header.generator == PackGeneratorFkm) {
+        pack_reader_rebuild(reader, block);
+        outcome = PackBlockRepaired;
+    }
+    if(reader->state[block] != outcome) {
+        // Counted once, however often the block is read again
+        OpenSesameApp* app = reader->app;
+        FURI_LOG_W("OpenSesame", "Pack k=%u n=%u: block %lu damaged, %s", reader->header.k,
+            reader->header.n, block, outcome == PackBlockRepaired ? "rebuilt" : "skipped");
+        OPENSESAME_EVENT(app, EventPackDamaged, outcome,
+            PREFETCH_KEY(reader->header.k, reader->header.n), block);
+        app->sequence_cache.pack_damaged++;
+        reader->damaged++;
+        reader->state[block] = outcome;
+    }
+    if(outcome == PackBlockSkipped) {
+        reader->block = UINT32_MAX;
+        return false;
+    }
+    reader->block = block;
+    return true;
+}
+
+// Skipped digits read as 0
+static uint8_t pack_reader_digit(PackReader* reader, uint32_t index) {
+    if(!pack_reader_load(reader, index / PACK_BLOCK_DIGITS)) return 0;
+    return opensesame_packed_digit(reader->data, index % PACK_BLOCK_DIGITS);
+}
+
+// --- Sequence Cache ---
+// Generated de Bruijn sequences depend only on (k, n), so they are kept
+// packed for the whole app session and shared by every target with the
+// same alphabet and order. Unpinned entries are evicted least recently
+// used first when the cache budget or the free heap floor is exceeded.
+static void sequence_cache_evict(SequenceCache* cache, SequenceCacheEntry* entry) {
+    FURI_LOG_D("OpenSesame", "Cache: evicting k=%u n=%u", entry->k, entry->n);
+    cache->bytes -= PACKED_SEQUENCE_BYTES(entry->num_codes);
+    free(entry->packed);
+    memset(entry, 0, sizeof(SequenceCacheEntry));
+}
+
+static SequenceCacheEntry* sequence_cache_lru_unpinned(SequenceCache* cache) {
+    SequenceCacheEntry* lru = NULL;
+    for(uint8_t i = 0; i < SEQUENCE_CACHE_SLOTS; i++) {
+        SequenceCacheEntry* entry = &cache->entries[i];
+        if(entry->packed == NULL || entry->pins > 0) continue;
+        if(lru == NULL || (int32_t)(entry->last_used - lru->last_used) < 0) lru = entry;
+    }
+    return lru;
+}
+
+// The cache functions below expect cache->mutex to be held
+static SequenceCacheEntry* sequence_cache_find(SequenceCache* cache, uint8_t k, uint8_t n) {
+    for(uint8_t i = 0; i < SEQUENCE_CACHE_SLOTS; i++) {
+        SequenceCacheEntry* entry = &cache->entries[i];
+        if(entry->packed != NULL && entry->k == k && entry->n == n) return entry;
+    }
+    return NULL;
+}
+
+static SequenceCacheEntry* sequence_cache_lookup(SequenceCache* cache, uint8_t k, uint8_t n) {
+    SequenceCacheEntry* entry = sequence_cache_find(cache, k, n);
+    if(entry == NULL) {
+        cache->misses++;
+        return NULL;
+    }
+    entry->pins++;
+    entry->last_used = furi_get_tick();
+    cache->hits++;
+    return entry;
+}
+
+// Takes ownership of 'packed'. Returns NULL if no slot can be freed, in
+// which case the caller keeps ownership. If the worker and the prefetch
+// thread both generated (k, n), the entry already cached wins.
+static SequenceCacheEntry* sequence_cache_insert(
+    SequenceCache* cache,
+    uint8_t k,
+    uint8_t n,
+    uint32_t num_codes,
+    uint8_t* packed) {
+    const size_t size = PACKED_SEQUENCE_BYTES(num_codes);
+    SequenceCacheEntry* slot = sequence_cache_find(cache, k, n);
+    if(slot != NULL) {
+        free(packed);
+        slot->pins++;
+        slot->last_used = furi_get_tick();
+        return slot;
+    }
+
+    while(true) {
+        slot = NULL;
+        for(uint8_t i = 0; i < SEQUENCE_CACHE_SLOTS && slot == NULL; i++) {
+            if(cache->entries[i].packed == NULL) slot = &cache->entries[i];
+        }
+        if(slot != NULL && cache->bytes + size <= SEQUENCE_CACHE_BUDGET &&
+           memmgr_get_free_heap() >= SEQUENCE_CACHE_MIN_FREE_HEAP) {
+            break;
+        }
+
+        SequenceCacheEntry* victim = sequence_cache_lru_unpinned(cache);
+        if(victim == NULL) return NULL;
+        sequence_cache_evict(cache, victim);
+    }
+
+    slot->k = k;
+    slot->n = n;
+    slot->num_codes = num_codes;
+    slot->packed = packed;
+    slot->pins = 1;
+    slot->last_used = furi_get_tick();
+    cache->bytes += size;
+    return slot;
+}
+
+static void sequence_cache_release(SequenceCache* cache, SequenceCacheEntry* entry) {
+    UNUSED(cache);
+    if(entry->pins > 0) entry->pins--;
+}
+
+static void sequence_cache_free(SequenceCache* cache) {
+    for(uint8_t i = 0; i < SEQUENCE_CACHE_SLOTS; i++) {
+        if(cache->entries[i].packed != NULL) {
+            sequence_cache_evict(cache, &cache->entries[i]);
+        }
+    }
+}
+
+// --- Sequence Strategies ---
+// The plan compiler picks one per de Bruijn step from the free heap and
+// the SD card when the run starts. The step checks again when it begins,
+// since the cache and the heap change during the run. The FKM stream fits
+// any target, so no step is skipped for want of memory.
+static bool sequence_fits_ram(uint32_t num_codes) {
+    const size_t bytes = PACKED_SEQUENCE_BYTES(num_codes);
+    return bytes <= SEQUENCE_CACHE_BUDGET && memmgr_heap_get_max_free_block() >= bytes &&
+           memmgr_get_free_heap() >= bytes + SEQUENCE_CACHE_MIN_FREE_HEAP;
+}
+
+static SequenceStrategy sequence_strategy_pick(
+    OpenSesameApp* app,
+    uint8_t k,
+    uint8_t n,
+    uint32_t num_codes) {
+    SequenceCache* cache = &app->sequence_cache;
+    furi_mutex_acquire(cache->mutex, FuriWaitForever);
+    const bool cached = sequence_cache_find(cache, k, n) != NULL;
+    furi_mutex_release(cache->mutex);
+
+    if(cached) return SequenceStrategyCache;
+    if(sequence_fits_ram(num_codes)) return SequenceStrategyRam;
+    if(pack_available(app, k, n, num_codes)) return SequenceStrategyPack;
+    return SequenceStrategyStream;
+}
+
+static void opensesame_plan_pick_strategies(OpenSesameApp* app, AttackPlan* plan) {
+    uint8_t counts[SequenceStrategyCount] = {0};
+    for(uint8_t i = 0; i < plan->count; i++) {
+        const OpenSesameTarget* target = &opensesame_targets[plan->target_idx[i]];
+        plan->strategy[i] = SequenceStrategyStream;
+        if(app->attack_mode != AttackModeDeBruijn || !opensesame_target_fits_debruijn(target)) {
+            continue;
+        }
+        const uint32_t num_codes =
+            (uint32_t)opensesame_target_code_count(target, AttackModeDeBruijn);
+        plan->strategy[i] = sequence_strategy_pick(app, target->radix, target->bits, num_codes);
+        counts[plan->strategy[i]]++;
+    }
+    if(app->attack_mode == AttackModeDeBruijn) {
+        FURI_LOG_I("OpenSesame", "Plan strategies: %u cache, %u ram, %u pack, %u stream",
+            counts[SequenceStrategyCache], counts[SequenceStrategyRam],
+            counts[SequenceStrategyPack], counts[SequenceStrategyStream]);
+    }
+}
+
+// --- Attack Steps ---
+// Streams the sequence with the FKM generator. Rotating a stream costs a
+// pass over the whole sequence, then generating up to the offset, so the
+// largest ones start at digit 0 instead.
+static void opensesame_step_stream_sequence(AttackStep* step, const CodeOrder* order) {
+    step->start_offset = 0;
+    if(step->num_codes <= STREAM_ROTATE_CODES_MAX) {
+        debruijn_stream_init(&step->stream, step->k, step->n);
+        const SequenceSource pass = {.stream = &step->stream};
+        step->start_offset =
+            code_order_debruijn_offset(order, &pass, step->num_codes, step->k, step->n);
+    }
+
+    debruijn_stream_init(&step->stream, step->k, step->n);
+    for(uint32_t i = 0; i < step->start_offset; i++) {
+        if(i % STOP_CHECK_DIGITS == 0 && worker_stop_requested()) break;
+        debruijn_stream_next(&step->stream);
+    }
+    step->source.stream = &step->stream;
+}
+
+// Points the step at its sequence with the fastest strategy it can afford
+// now and sets its start offset. Sequences generated in RAM go to the
+// cache, or are owned by the step if it is full, and are written as packs
+// once the step ends, off the path to its first chunk.
+static bool opensesame_step_load_sequence(OpenSesameApp* app, AttackStep* step) {
+    SequenceCache* cache = &app->sequence_cache;
+
+    // The prefetch thread may be generating this very sequence: wait for it
+    while(cache->generating == PREFETCH_KEY(step->k, step->n)) {
+        if(clock_sleep_ms(&app->device_clock, 5)) return false;
+    }
+
+    furi_mutex_acquire(cache->mutex, FuriWaitForever);
+    SequenceCacheEntry* entry = sequence_cache_lookup(cache, step->k, step->n);
+    furi_mutex_release(cache->mutex);
+    if(entry != NULL) {
+        OPENSESAME_EVENT(app, EventCacheHit, step->k, step->n, 0);
+        step->strategy = SequenceStrategyCache;
+        step->sequence = entry;
+        step->source.packed = entry->packed;
+        step->start_offset = entry->prior_offset;
+        return true;
+    }
+    OPENSESAME_EVENT(app, EventCacheMiss, step->k, step->n, 0);
+
+    if(!sequence_fits_ram(step->num_codes)) {
+        step->pack = pack_reader_open(app, step->k, step->n, step->num_codes);
+        if(step->pack == NULL) {
+            step->strategy = SequenceStrategyStream;
+            opensesame_step_stream_sequence(step, &step->order);
+            return true;
+        }
+        OPENSESAME_EVENT(app, EventPackLoad, step->k, step->n, step->pack->header.block_count);
+        app->sequence_cache.pack_loads++;
+        step->strategy = SequenceStrategyPack;
+        step->source.pack = step->pack;
+        // The rotation was stored with the pack: scanning for it would read
+        // every block before the first chunk. Only other priors rescan.
+        const PackHeader* header = &step->pack->header;
+        step->start_offset = (header->prior_key == pack_prior_key(&step->order)) ?
+                                 header->prior_offset :
+                                 code_order_debruijn_offset(
+                                     &step->order, &step->source, step->num_codes, step->k, step->n);
+        return true;
+    }
+    step->strategy = SequenceStrategyRam;
+
+    OPENSESAME_SPAN_BEGIN(app, TraceSpanGenerate, TraceTrackWorker, PREFETCH_KEY(step->k, step->n));
+    uint8_t* packed = opensesame_debruijn_generate_packed(
+        step->k, step->n, step->num_codes, app->tuning.yield_digits);
+    if(packed == NULL) {
+        OPENSESAME_SPAN_END(app, TraceSpanGenerate, TraceTrackWorker);
+        return false;
+    }
+    // The generator yields 1 ms at a time, which the virtual clock skips
+    if(app->clock == &app->device_clock) {
+        step->yield_us = (uint64_t)(step->num_codes / app->tuning.yield_digits) * 1000;
+    }
+
+    // The rotation only depends on (k, n) and the prior set, so cache it too
+    const SequenceSource source = {.packed = packed};
+    uint32_t prior_offset =
+        code_order_debruijn_offset(&step->order, &source, step->num_codes, step->k, step->n);
+    OPENSESAME_SPAN_END(app, TraceSpanGenerate, TraceTrackWorker);
+    step->pack_unwritten = true;
+
+    furi_mutex_acquire(cache->mutex, FuriWaitForever);
+    entry = sequence_cache_insert(cache, step->k, step->n, step->num_codes, packed);
+    if(entry != NULL) entry->prior_offset = prior_offset;
+    furi_mutex_release(cache->mutex);
+    if(entry == NULL) {
+        OPENSESAME_EVENT(app, EventCacheFull, step->k, step->n, 0);
+        entry = &step->owned_sequence;
+        entry->k = step->k;
+        entry->n = step->n;
+        entry->num_codes = step->num_codes;
+        entry->packed = packed;
+        entry->prior_offset = prior_offset;
+    }
+    step->sequence = entry;
+    step->source.packed = packed;
+    step->start_offset = prior_offset;
+    return true;
+}
+
+// Generates the sequence for a plan target into the cache ahead of its
+// step, unpinned, so the step finds it on a cache hit, and writes its pack.
+// Only for steps planned in RAM, and only while they still fit. Runs on the
+// prefetch thread while the worker is waiting on the radio.
+static void opensesame_sequence_prefetch(OpenSesameApp* app, uint8_t target_idx) {
+    SequenceCache* cache = &app->sequence_cache;
+    const OpenSesameTarget* target = &opensesame_targets[target_idx];
+    if(!opensesame_target_fits_debruijn(target)) return;
+
+    const uint8_t k = target->radix;
+    const uint8_t n = target->bits;
+    const CodeSpace space = opensesame_target_code_space(target, AttackModeDeBruijn);
+    const uint32_t num_codes = (uint32_t)code_space_count(&space);
+
+    if(!sequence_fits_ram(num_codes)) return;
+
+    furi_mutex_acquire(cache->mutex, FuriWaitForever);
+    bool cached = sequence_cache_find(cache, k, n) != NULL;
+    if(!cached) cache->generating = PREFETCH_KEY(k, n);
+    furi_mutex_release(cache->mutex);
+    if(cached) return;
+
+    OPENSESAME_SPAN_BEGIN(app, TraceSpanGenerate, TraceTrackPrefetch, PREFETCH_KEY(k, n));
+    CodeOrder* order = malloc(sizeof(CodeOrder));
+    uint8_t* packed = NULL;
+    if(order != NULL) {
+        code_order_init(order, &space, NULL, 0);
+        packed = opensesame_debruijn_generate_packed(k, n, num_codes, app->tuning.yield_digits);
+    }
+
+    if(packed != NULL) {
+        const SequenceSource source = {.packed = packed};
+        uint32_t prior_offset = code_order_debruijn_offset(order, &source, num_codes, k, n);
+        OPENSESAME_SPAN_END(app, TraceSpanGenerate, TraceTrackPrefetch);
+        if(!pack_available(app, k, n, num_codes)) {
+            pack_write(app, k, n, packed, num_codes, order, prior_offset);
+        }
+
+        furi_mutex_acquire(cache->mutex, FuriWaitForever);
+        SequenceCacheEntry* entry = sequence_cache_insert(cache, k, n, num_codes, packed);
+        if(entry != NULL) {
+            entry->prior_offset = prior_offset;
+            sequence_cache_release(cache, entry);
+        } else {
+            free(packed);
+        }
+        furi_mutex_release(cache->mutex);
+        OPENSESAME_EVENT(app, EventPrefetch, k, n, entry != NULL);
+    } else {
+        OPENSESAME_SPAN_END(app, TraceSpanGenerate, TraceTrackPrefetch);
+    }
+
+    free(order);
+    cache->generating = 0;
+}
+
+// Restarts the rotation so the windows of recorded hits come first. The
+// shared order and the cached offset stay as they are for other runs.
+static void opensesame_step_rotate_to_hits(AttackStep* step, const HistoryAggregate* aggregate) {
+    CodeOrder* hits = malloc(sizeof(CodeOrder));
+    if(hits == NULL) return;
+
+    memset(hits, 0, sizeof(CodeOrder));
+    hits->max_code = step->order.max_code;
+    for(uint8_t i = 0; i < aggregate->hit_count; i++) {
+        code_order_add_prior(hits, aggregate->hits[i]);
+    }
+    code_order_sort(hits);
+
+    if(step->strategy == SequenceStrategyStream) {
+        opensesame_step_stream_sequence(step, hits);
+    } else {
+        step->start_offset =
+            code_order_debruijn_offset(hits, &step->source, step->num_codes, step->k, step->n);
+    }
+    free(hits);
+}
+
+static StepBeginResult opensesame_step_begin(OpenSesameApp* app, AttackStep* step, uint8_t target_idx) {
+    memset(step, 0, sizeof(AttackStep));
+    step->start_ms = clock_now_ms(app->clock);
+    const uint64_t begin_us = clock_now_us(app->clock);
+
+    HistoryAggregate aggregate;
+    if(!history_lookup(&app->history, target_idx, app->attack_mode, &aggregate)) {
+        aggregate.hit_count = 0;
+    }
+
+    const OpenSesameTarget* target = &opensesame_targets[target_idx];
+    step->target_idx = target_idx;
+    step->target = target;
+    step->k = target->radix;
+    step->n = target->bits;
+    step->band = duty_band_for_frequency(target->frequency);
+    step->space = opensesame_target_code_space(target, app->attack_mode);
+    step->num_codes = (uint32_t)code_space_count(&step->space);
+
+    OPENSESAME_EVENT(app, EventStepBegin, target_idx, (step->k << 8) | step->n, step->num_codes);
+
+    if(app->attack_mode != AttackModeDeBruijn) {
+        code_order_init(&step->order, &step->space, aggregate.hits, aggregate.hit_count);
+        step->payload_size_bytes = (target->bits * target->length + 7) / 8;
+        step->setup_us = clock_now_us(app->clock) - begin_us;
+        step->active = true;
+        return StepBeginOk;
+    }
+
+    if(!opensesame_target_fits_debruijn(target)) {
+        OPENSESAME_EVENT(app, EventStepSkip, target_idx, step->n, 0);
+        return StepBeginSkip;
+    }
+
+    app->code_buffer.head = 0;
+    app->code_buffer.count = 0;
+
+    step->divisor = step->num_codes / step->k;
+    code_order_init(&step->order, &step->space, NULL, 0);
+    if(!opensesame_step_load_sequence(app, step)) {
+        return (furi_thread_flags_get() & WORKER_EVENT_STOP) ? StepBeginStopped : StepBeginFailed;
+    }
+    if(aggregate.hit_count > 0) opensesame_step_rotate_to_hits(step, &aggregate);
+    if(worker_stop_requested()) return StepBeginStopped; // Rotation may be cut short
+
+    OPENSESAME_EVENT(app, EventStrategy, target_idx, step->strategy, memmgr_get_free_heap());
+    OPENSESAME_EVENT(app, EventPriorOffset, target_idx, step->order.prior_count, step->start_offset);
+    app->sequence_strategy = step->strategy;
+    app->strategy_steps[step->strategy]++;
+
+    step->total_digits = step->num_codes + (step->n - 1);
+    const uint64_t load_us = clock_now_us(app->clock) - begin_us;
+    step->setup_us = (load_us > step->yield_us) ? load_us - step->yield_us : 0;
+    step->active = true;
+    return StepBeginOk;
+}
+
+static void opensesame_step_end(OpenSesameApp* app, AttackStep* step) {
+    if(step->active) {
+        run_report_record_step(app, step);
+        history_record_step(app, step);
+    }
+    // The sequence is still held here. A stop skips the write.
+    if(step->pack_unwritten && !worker_stop_requested() &&
+       !pack_available(app, step->k, step->n, step->num_codes)) {
+        pack_write(app, step->k, step->n, step->sequence->packed, step->num_codes, &step->order,
+            step->sequence->prior_offset);
+    }
+    if(step->sequence == &step->owned_sequence) {
+        free(step->owned_sequence.packed);
+        step->owned_sequence.packed = NULL;
+    } else if(step->sequence != NULL) {
+        furi_mutex_acquire(app->sequence_cache.mutex, FuriWaitForever);
+        sequence_cache_release(&app->sequence_cache, step->sequence);
+        furi_mutex_release(app->sequence_cache.mutex);
+    }
+    if(step->pack != NULL) pack_reader_close(step->pack);
+    step->sequence = NULL;
+    step->pack = NULL;
+    step->pack_unwritten = false;
+    step->active = false;
+}
+
+// Frequency offsets each chunk is repeated on (none unless drift sweep is on)
+static const int32_t* opensesame_target_offsets(
+    const OpenSesameApp* app,
+    const OpenSesameTarget* target,
+    uint8_t* count) {
+    *count = app->drift_sweep ? target->freq_offset_count : 0;
+    return target->freq_offsets;
+}
+
+// Bit periods each chunk is rendered at, shortest first
+static const uint16_t* opensesame_bit_periods(const OpenSesameApp* app, uint8_t* count) {
+    static const uint16_t nominal_period_us = BIT_PERIOD_US;
+    if(!app->rate_sweep) {
+        *count = 1;
+        return &nominal_period_us;
+    }
+    *count = BIT_PERIOD_VARIANTS_MAX;
+    return opensesame_bit_periods_us;
+}
+
+// Sum of all bit periods in use: airtime of one bit across every variant
+static uint32_t opensesame_bit_period_sum_us(const OpenSesameApp* app) {
+    uint8_t count;
+    const uint16_t* periods = opensesame_bit_periods(app, &count);
+    uint32_t sum = 0;
+    for(uint8_t i = 0; i < count; i++) sum += periods[i];
+    return sum;
+}
+
+// Compatibility keeps the original spacing: its gaps sit between whole
+// codes and are part of what the receiver sees
+static const TxTuning* opensesame_tuning(const OpenSesameApp* app) {
+    return (app->attack_mode == AttackModeCompatibility) ? &tuning_defaults : &app->tuning;
+}
+
+// Codes (Stream) or digits (de Bruijn) per chunk: as many as the tuned
+// chunk airtime holds at the nominal bit period, within CHUNK_BYTES_MAX
+static uint32_t opensesame_chunk_payloads(const OpenSesameApp* app, const OpenSesameTarget* target) {
+    if(app->attack_mode == AttackModeCompatibility) return 1;
+
+    const uint32_t payload_bits = (app->attack_mode == AttackModeStream) ?
+                                      ((target->bits * target->length + 7) / 8) * 8 :
+                                      target->length;
+    // Restricted bands are paced by the governor, not by chunk overhead,
+    // and short chunks fit its refills more closely
+    const uint32_t chunk_airtime_ms = opensesame_tuning(app)->chunk_airtime_ms;
+    const uint32_t max_payloads = CHUNK_BYTES_MAX * 8 / payload_bits;
+    if(chunk_airtime_ms == 0 || duty_band_for_frequency(target->frequency) != DUTY_BAND_NONE) {
+        return MIN((uint32_t)PAYLOADS_PER_CHUNK, max_payloads);
+    }
+
+    const uint32_t payloads = chunk_airtime_ms * 1000 / (payload_bits * BIT_PERIOD_US);
+    return CLAMP(payloads, max_payloads, 1UL);
+}
+
+// Worst-case airtime of one chunk for 'target' on all of its frequency and
+// timing variants, used to consult the governor
+static uint32_t opensesame_chunk_airtime_us(const OpenSesameApp* app, const OpenSesameTarget* target) {
+    uint8_t offset_count;
+    opensesame_target_offsets(app, target, &offset_count);
+
+    const size_t payload_size_bytes = (target->bits * target->length + 7) / 8;
+    const uint32_t payloads = opensesame_chunk_payloads(app, target);
+    size_t bytes;
+    switch(app->attack_mode) {
+    case AttackModeCompatibility:
+        bytes = payload_size_bytes;
+        break;
+    case AttackModeStream:
+        bytes = payload_size_bytes * payloads;
+        break;
+    default:
+        bytes = (target->length * payloads + 7) / 8;
+        break;
+    }
+    return bytes * 8 * opensesame_bit_period_sum_us(app) * (1 + offset_count);
+}
+
+// --- Airtime Estimator ---
+static uint64_t opensesame_estimate_target_airtime_us(
+    const OpenSesameApp* app,
+    const OpenSesameTarget* target) {
+    const uint64_t num_codes = opensesame_target_code_count(target, app->attack_mode);
+    uint64_t bits;
+
+    if(app->attack_mode == AttackModeDeBruijn) {
+        // Whole chunks plus the final partial chunk
+        const uint32_t payloads = opensesame_chunk_payloads(app, target);
+        const uint32_t total_digits = num_codes + (target->bits - 1);
+        const uint32_t full_chunks = total_digits / payloads;
+        const uint32_t rest = total_digits % payloads;
+        bits = (uint64_t)full_chunks * ((target->length * payloads + 7) / 8) * 8 +
+               ((rest * target->length + 7) / 8) * 8;
+    } else {
+        bits = (uint64_t)num_codes * ((target->bits * target->length + 7) / 8) * 8;
+    }
+
+    uint8_t offset_count;
+    opensesame_target_offsets(app, target, &offset_count);
+    return bits * opensesame_bit_period_sum_us(app) * (1 + offset_count);
+}
+
+static uint64_t opensesame_estimate_plan_airtime_us(const OpenSesameApp* app, const AttackPlan* plan) {
+    uint64_t total = 0;
+    for(uint8_t i = 0; i < plan->count; i++) {
+        total += opensesame_estimate_target_airtime_us(app, &opensesame_targets[plan->target_idx[i]]);
+    }
+    return total;
+}
+
+// Wall time of a target on one radio without duty-cycle waits: airtime
+// plus the scheduler's gaps, or as measured
+static uint64_t opensesame_estimate_target_wall_us(
+    const OpenSesameApp* app,
+    const OpenSesameTarget* target) {
+    const uint64_t airtime_us = opensesame_estimate_target_airtime_us(app, target);
+
+    // Once enough of it is measured, use the history's wall time per unit
+    // of airtime. Restricted bands also wait on the governor, which the
+    // history cannot tell apart, so they keep the gap model.
+    HistoryAggregate aggregate;
+    if(duty_band_for_frequency(target->frequency) == DUTY_BAND_NONE &&
+       history_lookup(&app->history, target - opensesame_targets, app->attack_mode, &aggregate) &&
+       aggregate.airtime_ms >= HISTORY_MIN_SAMPLE_MS) {
+        const uint64_t ratio = aggregate.wall_ms * 1024 / aggregate.airtime_ms;
+        return airtime_us * ratio / 1024;
+    }
+
+    const uint32_t chunk_us = opensesame_chunk_airtime_us(app, target);
+    uint8_t offset_count, period_count;
+    opensesame_target_offsets(app, target, &offset_count);
+    opensesame_bit_periods(app, &period_count);
+
+    // A gap after every variant and another after each chunk
+    const TxTuning* tuning = opensesame_tuning(app);
+    const uint64_t chunks = (airtime_us + chunk_us - 1) / chunk_us;
+    const uint32_t gaps_ms =
+        (offset_count + 1) * period_count * tuning->variant_gap_ms + tuning->chunk_gap_ms;
+    return airtime_us + chunks * gaps_ms * 1000;
+}
+
+// --- Run Report ---
+static void run_report_start(OpenSesameApp* app) {
+    RunReport* report = &app->report;
+    if(report->steps == NULL) report->steps = malloc(PLAN_MAX_STEPS * sizeof(ReportStep));
+    report->count = 0;
+    report->flagged = 0;
+    report->estimate_airtime_ms = 0;
+    report->airtime_ms = 0;
+    report->overhead_ms = 0;
+}
+
+// Worker only: the estimates are scaled to the share of the target the
+// step sent, so a stopped step is compared with what it did
+static void run_report_record_step(OpenSesameApp* app, const AttackStep* step) {
+    RunReport* report = &app->report;
+    if(report->steps == NULL || report->count >= PLAN_MAX_STEPS) return;
+
+    const uint32_t units =
+        (app->attack_mode == AttackModeDeBruijn) ? step->total_digits : step->num_codes;
+    const uint32_t sent = MIN(step->sent, units);
+    ReportStep* entry = &report->steps[report->count];
+    memset(entry, 0, sizeof(ReportStep));
+    entry->target = step->target_idx;
+    if(units > 0) {
+        entry->estimate_airtime_ms =
+            opensesame_estimate_target_airtime_us(app, step->target) / 1000 * sent / units;
+        entry->estimate_wall_ms =
+            opensesame_estimate_target_wall_us(app, step->target) / 1000 * sent / units;
+    }
+    entry->airtime_ms = (uint32_t)(step->airtime_us / 1000);
+    entry->wall_ms = clock_now_ms(app->clock) - step->start_ms;
+    entry->setup_ms = (uint32_t)(step->setup_us / 1000);
+    entry->gap_ms = (uint32_t)(step->gap_us / 1000);
+    entry->yield_ms = (uint32_t)(step->yield_us / 1000);
+    entry->idle_ms = (uint32_t)(step->idle_us / 1000);
+    entry->shared_ms = (uint32_t)(step->shared_us / 1000);
+
+    const uint64_t unavoidable_ms =
+        (uint64_t)entry->airtime_ms + entry->idle_ms + entry->shared_ms;
+    entry->overhead_ms = (entry->wall_ms > unavoidable_ms) ? entry->wall_ms - unavoidable_ms : 0;
+    const uint32_t overhead_permille =
+        (entry->airtime_ms > 0) ? (uint64_t)entry->overhead_ms * 1000 / entry->airtime_ms : 0;
+    entry->flagged = overhead_permille > REPORT_OVERHEAD_FLAG_PERMILLE;
+    OPENSESAME_EVENT(app, EventReconcile, entry->target,
+        (entry->estimate_wall_ms > 0) ? (uint64_t)entry->wall_ms * 1000 / entry->estimate_wall_ms : 0,
+        overhead_permille);
+
+    report->flagged += entry->flagged;
+    report->estimate_airtime_ms += entry->estimate_airtime_ms;
+    report->airtime_ms += entry->airtime_ms;
+    report->overhead_ms += entry->overhead_ms;
+    report->count++;
+}
+
+// Setup, gaps and yields are what the cost model accounts for; other is
+// whatever the step spent that none of them explain
+static uint32_t run_report_other_ms(const ReportStep* entry) {
+    const uint64_t explained_ms = (uint64_t)entry->setup_ms + entry->gap_ms + entry->yield_ms;
+    return (entry->overhead_ms > explained_ms) ? entry->overhead_ms - explained_ms : 0;
+}
+
+static void run_report_finish(OpenSesameApp* app) {
+    const RunReport* report = &app->report;
+    if(report->steps == NULL) return;
+
+    for(uint8_t i = 0; i < report->count; i++) {
+        const ReportStep* entry = &report->steps[i];
+        if(!entry->flagged) continue;
+        FURI_LOG_W("OpenSesame", "Overhead %s: %lu ms over %lu ms airtime "
+            "(setup %lu, gaps %lu, yields %lu, other %lu)",
+            opensesame_targets[entry->target].name, entry->overhead_ms, entry->airtime_ms,
+            entry->setup_ms, entry->gap_ms, entry->yield_ms, run_report_other_ms(entry));
+    }
+    FURI_LOG_I("OpenSesame", "Report: %u steps, airtime %lu ms for %lu ms estimated, "
+        "overhead %lu ms, %u flagged",
+        report->count, (uint32_t)report->airtime_ms, (uint32_t)report->estimate_airtime_ms,
+        (uint32_t)report->overhead_ms, report->flagged);
+}
+
+static void opensesame_format_duration(char* out, size_t out_size, uint64_t duration_us) {
+    uint32_t seconds = (uint32_t)(duration_us / 1000000);
+    if(seconds >= 3600) {
+        snprintf(out, out_size, "%luh%02lum", seconds / 3600, (seconds % 3600) / 60);
+    } else if(seconds >= 60) {
+        snprintf(out, out_size, "%lum%02lus", seconds / 60, seconds % 60);
+    } else {
+        snprintf(out, out_size, "%lus", seconds);
+    }
+}
 
-        for(uint32_t code = 0; code < target_max_code; code++) {
-            if(furi_thread_flags_get() & WORKER_EVENT_STOP) break;
+// Encodes the next chunk of the step into 'chunk'. Returns bytes to send, 0 when done.
+static size_t opensesame_step_fill_chunk(OpenSesameApp* app, AttackStep* step, uint8_t* chunk) {
+    const OpenSesameTarget* target = step->target;
+    uint32_t code;
 
-            app->current_code = code; // For inner-loop display
-            app->codes_transmitted++; // For global progress bar
+    if(app->attack_mode == AttackModeCompatibility) {
+        if(!code_order_next(&step->order, &code)) return 0;
 
-            opensesame_generate_payload(code, current_target, single_payload, payload_size_bytes);
-            memcpy(chunk_buffer + (current_in_chunk * payload_size_bytes), single_payload, payload_size_bytes);
-            current_in_chunk++;
+        app->current_code = step->sent++; // For inner-loop display
+        app->codes_transmitted++; // For global progress bar
+        opensesame_generate_payload(code, target, &step->space, chunk, step->payload_size_bytes);
+        opensesame_push_code_to_buffer(app, code);
+        return step->payload_size_bytes;
+    }
+
+    const uint32_t payloads = opensesame_chunk_payloads(app, target);
+    if(app->attack_mode == AttackModeStream) {
+        size_t current_in_chunk = 0;
+        while(current_in_chunk < payloads && code_order_next(&step->order, &code)) {
+            app->current_code = step->sent++;
+            app->codes_transmitted++;
+            opensesame_generate_payload(
+                code,
+                target,
+                &step->space,
+                chunk + (current_in_chunk * step->payload_size_bytes),
+                step->payload_size_bytes);
             opensesame_push_code_to_buffer(app, code);
+            current_in_chunk++;
+        }
+        return current_in_chunk * step->payload_size_bytes;
+    }
 
-            if(current_in_chunk == PAYLOADS_PER_CHUNK || code == target_max_code - 1) {
-                size_t transmit_size = current_in_chunk * payload_size_bytes;
-                opensesame_transmit_raw(current_target->frequency, chunk_buffer, transmit_size);
-                memset(chunk_buffer, 0, chunk_size);
-                current_in_chunk = 0;
-                
-                furi_delay_ms(5);
-            }
+    // de Bruijn: the next digits of the rotated sequence
+    const size_t bytes_per_chunk = (target->length * payloads + 7) / 8;
+    memset(chunk, 0, bytes_per_chunk);
+    size_t bit_offset = 0;
+
+    for(size_t d = 0; d < payloads && step->sent < step->total_digits; d++) {
+        uint32_t i = step->sent++;
+        const uint32_t index = (step->start_offset + i) % step->num_codes;
+        if(step->pack != NULL && !pack_reader_load(step->pack, index / PACK_BLOCK_DIGITS)) {
+            // Skipped pack block: drop the rest of it and every window overlapping it
+            const uint32_t block_end =
+                MIN((index / PACK_BLOCK_DIGITS + 1) * PACK_BLOCK_DIGITS, step->num_codes);
+            step->sent = MIN(i + (block_end - index), step->total_digits);
+            step->window_digits = 0;
+            continue;
         }
-        free(chunk_buffer);
-        free(single_payload);
+        uint8_t digit = opensesame_sequence_digit(&step->source, index);
 
-        // Delay between targets in meta-modes
-        if((is_all_known || is_generic_brute || is_european_brute) && target_idx < target_end) {
-            if(target_idx + 1 != 4 && target_idx + 1 != 5 && target_idx + 1 != 6) {
-                furi_delay_ms(100);
-            }
+        step->code_register = ((step->code_register % step->divisor) * step->k) + digit;
+        if(step->window_digits < step->n) step->window_digits++;
+
+        if(step->window_digits == step->n) {
+            app->current_code = step->code_register;
+            app->codes_transmitted++;
+            opensesame_push_code_to_buffer(app, step->code_register);
         }
+
+        bit_offset = opensesame_append_digit_pattern(digit, target, chunk, bit_offset);
     }
-    return 0;
+    return (bit_offset + 7) / 8;
 }
 
-static int32_t opensesame_worker_debruijn(OpenSesameApp* app, const OpenSesameTarget* target) {
-    UNUSED(target); // We use app->current_target_index
-    
-    // Check which meta-mode is active, or if it's a single target
-    bool is_all_known = (app->current_target_index == 4);
-    bool is_generic_brute = (app->current_target_index == 5);
-    bool is_european_brute = (app->current_target_index == 6);
+// --- Scheduler ---
+// One step may be active per duty-cycle band, and one unrestricted step per
+// radio. Each radio keeps sending its current step while the band has
+// airtime left; when the governor forces idle time it moves to another
+// active step or the next planned target on another band, and the
+// scheduler only sleeps when every candidate band is exhausted. Radios
+// never send the same step or share a frequency.
+typedef struct {
+    RadioSession* radio;
+    uint8_t index; // Radio number in events
+    AttackStep* step; // Step whose chunk this radio is sending, NULL between chunks
+    uint8_t* chunk;
+    size_t bytes;
+    CodeRange codes; // Of the chunk, in the code buffer
+    uint32_t last_code;
+    uint8_t variant; // Next frequency and bit period combination of the chunk
+    uint8_t last_slot; // Step sent last, kept while its band has airtime
+    uint32_t ready_tick; // Gap after the previous transmission
+} RadioLane;
+
+// Next chunk of a step, encoded while the radio sends the current one
+typedef struct {
+    uint8_t* buffer;
+    size_t bytes; // 0 once the step has nothing left
+    CodeRange codes;
+    uint32_t last_code;
+    bool ready;
+} EncodedChunk;
 
-    uint8_t target_start = 0;
-    uint8_t target_end = 0;
+typedef struct {
+    AttackPlan* plan; // Long-run mode reorders and trims targets not yet started
+    AttackStep* steps;
+    EncodedChunk next[STEP_SLOT_COUNT]; // Per step slot
+    RadioLane lanes[RADIO_MAX];
+    uint8_t lane_count;
+    bool started[PLAN_MAX_STEPS];
+    uint8_t pending;
+    bool is_meta;
+
+    // Sequence generation for upcoming targets, overlapping transmission
+    FuriThread* prefetch_thread;
+    FuriMessageQueue* prefetch_queue; // Plan indices, bounded
+    uint8_t prefetch_posted; // Plan entries handed to the prefetch thread
+} Scheduler;
+
+// Another radio is sending 'step' or something on 'frequency'
+static bool scheduler_conflicts(
+    const Scheduler* sched,
+    uint8_t lane,
+    const AttackStep* step,
+    uint32_t frequency) {
+    for(uint8_t l = 0; l < sched->lane_count; l++) {
+        const AttackStep* other = sched->lanes[l].step;
+        if(l == lane || other == NULL) continue;
+        if(other == step || other->target->frequency == frequency) return true;
+    }
+    return false;
+}
 
-    if(is_generic_brute) {
-        target_start = 0;
-        target_end = 67; // Index of last generic target
-    } else if(is_all_known) {
-        target_start = 0;
-        target_end = 3; // The 4 known models
-    } else if(is_european_brute) {
-        target_start = 68; // Index of first European target
-        target_end = opensesame_total_target_count - 1; // 81
-    } else { // Single target
-        target_start = app->current_target_index;
-        target_end = app->current_target_index;
+static uint8_t scheduler_free_slot(const Scheduler* sched, uint8_t band) {
+    if(band != DUTY_BAND_NONE) {
+        return sched->steps[band].active ? STEP_SLOT_NONE : band;
     }
-    
-    // app->codes_transmitted is reset in submenu callback
-    
-    for(uint8_t target_idx = target_start; target_idx <= target_end; target_idx++) {
-        // Skip the meta-targets themselves
-        if(target_idx == 4 || target_idx == 5 || target_idx == 6) continue; 
-        
-        if(furi_thread_flags_get() & WORKER_EVENT_STOP) break;
-        
-        app->code_buffer.head = 0;
-        app->code_buffer.count = 0;
-        app->current_attack_target_idx = target_idx;
-        
-        const OpenSesameTarget* current_target = &opensesame_targets[target_idx];
-        
-        FURI_LOG_I("OpenSesame", "de Bruijn: Starting %s", current_target->name);
+    for(uint8_t s = DUTY_BAND_COUNT; s < DUTY_BAND_COUNT + sched->lane_count; s++) {
+        if(!sched->steps[s].active) return s;
+    }
+    return STEP_SLOT_NONE;
+}
 
-        const uint8_t n = current_target->bits;
-        const uint8_t k = current_target->trinary ? 3 : 2;
+// Gives 'lane' a step with airtime left. StepBeginSkip means nothing can be
+// sent right now; 'min_wait_ms' then holds the soonest governor refill.
+static StepBeginResult scheduler_pick(
+    OpenSesameApp* app,
+    Scheduler* sched,
+    uint8_t lane_idx,
+    uint32_t* min_wait_ms) {
+    RadioLane* lane = &sched->lanes[lane_idx];
+    AttackStep* steps = sched->steps;
+
+    // 1. Keep going on the last step while its band allows it
+    AttackStep* last = &steps[lane->last_slot];
+    if(last->active && !scheduler_conflicts(sched, lane_idx, last, last->target->frequency) &&
+       airtime_governor_wait_ms(
+           &app->governor, last->band, opensesame_chunk_airtime_us(app, last->target)) == 0) {
+        lane->step = last;
+        return StepBeginOk;
+    }
 
-        // --- de Bruijn specific skips ---
-        if((!current_target->trinary && n > 13) || (current_target->trinary && n > 8)) {
-            FURI_LOG_E("OpenSesame", "Target '%s' (%d bits) too large for de Bruijn, skipping.",
-                current_target->name, n);
-            if(!is_all_known && !is_generic_brute && !is_european_brute) {
-                return -1;
-            }
-            continue; 
+    // 2. Otherwise any other active step with airtime left
+    for(uint8_t s = 0; s < STEP_SLOT_COUNT; s++) {
+        if(!steps[s].active ||
+           scheduler_conflicts(sched, lane_idx, &steps[s], steps[s].target->frequency)) {
+            continue;
         }
-        
-        const uint32_t num_codes = (uint32_t)pow(k, n);
-        const uint32_t divisor = (uint32_t)pow(k, n - 1);
+        uint32_t wait = airtime_governor_wait_ms(
+            &app->governor, steps[s].band, opensesame_chunk_airtime_us(app, steps[s].target));
+        if(wait == 0) {
+            lane->step = &steps[s];
+            lane->last_slot = s;
+            return StepBeginOk;
+        }
+        if(wait < *min_wait_ms) *min_wait_ms = wait;
+    }
 
-        size_t seen_size = num_codes * sizeof(bool);
-        size_t sequence_size = num_codes * sizeof(uint8_t);
-        if(seen_size > 10000 || sequence_size > 10000) {
-            FURI_LOG_E("OpenSesame", "Memory allocation too large, aborting");
-            return -1;
+    // 3. Otherwise start the next planned target on a free slot with airtime
+    for(uint8_t p = 0; p < sched->plan->count; p++) {
+        if(sched->started[p]) continue;
+
+        const OpenSesameTarget* t = &opensesame_targets[sched->plan->target_idx[p]];
+        if(scheduler_conflicts(sched, lane_idx, NULL, t->frequency)) continue;
+        uint8_t band = duty_band_for_frequency(t->frequency);
+        uint8_t slot = scheduler_free_slot(sched, band);
+        if(slot == STEP_SLOT_NONE) continue;
+
+        uint32_t wait =
+            airtime_governor_wait_ms(&app->governor, band, opensesame_chunk_airtime_us(app, t));
+        if(wait > 0) {
+            if(wait < *min_wait_ms) *min_wait_ms = wait;
+            continue;
         }
 
-        bool* seen = malloc(seen_size);
-        if(seen == NULL) {
-            FURI_LOG_E("OpenSesame", "Failed to allocate seen array");
-            return -1;
+        sched->started[p] = true;
+        sched->pending--;
+        OPENSESAME_SPAN_BEGIN(
+            app, TraceSpanStep, TraceTrackStep + slot, sched->plan->target_idx[p]);
+        StepBeginResult begin = opensesame_step_begin(app, &steps[slot], sched->plan->target_idx[p]);
+        if(begin == StepBeginOk) {
+            lane->step = &steps[slot];
+            lane->last_slot = slot;
+            return StepBeginOk;
         }
-        
-        uint8_t* sequence = malloc(sequence_size);
-        if(sequence == NULL) {
-            FURI_LOG_E("OpenSesame", "Failed to allocate sequence");
-            free(seen);
-            return -1;
-        }
-
-        memset(seen, 0, seen_size);
-        for(uint8_t i = 0; i < n; i++) {
-            sequence[i] = 0;
-        }
-        seen[0] = true;
-        uint32_t current_code_val = 0;
-
-        for(uint32_t i = n; i < num_codes; i++) {
-            current_code_val = (current_code_val % divisor) * k;
-
-            int d;
-            for(d = (int)k - 1; d >= 0; d--) {
-                uint32_t next_code_val = current_code_val + (uint32_t)d;
-                if(!seen[next_code_val]) {
-                    seen[next_code_val] = true;
-                    sequence[i] = (uint8_t)d;
-                    current_code_val = next_code_val;
-                    goto next_digit;
-                }
-            }
-            sequence[i] = 0;
-            current_code_val = current_code_val + 0;
-
-        next_digit:
-            if(i % 50 == 0) {
-                furi_delay_ms(1);
-                if(furi_thread_flags_get() & WORKER_EVENT_STOP) {
-                    free(seen);
-                    free(sequence);
-                    return 0;
-                }
-            }
+        OPENSESAME_SPAN_END(app, TraceSpanStep, TraceTrackStep + slot);
+        if(begin == StepBeginSkip && sched->is_meta) continue;
+        return (begin == StepBeginSkip) ? StepBeginFailed : begin;
+    }
+    return StepBeginSkip;
+}
+
+// Nominal frequency first, then each drift offset on the same session;
+// on every frequency the chunk goes out at each bit period, shortest first
+static uint8_t scheduler_variant_count(const OpenSesameApp* app, const AttackStep* step) {
+    uint8_t offset_count, period_count;
+    opensesame_target_offsets(app, step->target, &offset_count);
+    opensesame_bit_periods(app, &period_count);
+    return (offset_count + 1) * period_count;
+}
+
+// The whole chunk is charged before its first variant, as the pick waited
+// for all of them: another radio on the band cannot take the airtime
+// between them. A refused variant keeps its share. The pick sized its wait
+// from an estimate, so a refusal keeps the chunk and waits like the pick.
+static bool scheduler_charge_chunk(OpenSesameApp* app, RadioLane* lane, uint32_t* min_wait_ms) {
+    uint8_t offset_count;
+    opensesame_target_offsets(app, lane->step->target, &offset_count);
+    const uint32_t airtime_us =
+        lane->bytes * 8 * opensesame_bit_period_sum_us(app) * (offset_count + 1);
+    if(airtime_governor_charge(&app->governor, lane->step->band, airtime_us)) return true;
+
+    const uint32_t wait = airtime_governor_wait_ms(&app->governor, lane->step->band, airtime_us);
+    if(wait < *min_wait_ms) *min_wait_ms = wait;
+    return false;
+}
+
+static bool scheduler_send_variant(OpenSesameApp* app, RadioLane* lane) {
+    uint8_t offset_count, period_count;
+    const int32_t* offsets = opensesame_target_offsets(app, lane->step->target, &offset_count);
+    const uint16_t* periods = opensesame_bit_periods(app, &period_count);
+    const uint8_t v = lane->variant / period_count;
+    const uint8_t r = lane->variant % period_count;
+    const uint32_t frequency = lane->step->target->frequency + ((v == 0) ? 0 : offsets[v - 1]);
+
+    uint32_t airtime_us = lane->bytes * 8 * periods[r];
+    lane->variant++;
+    const uint64_t setup_start_us = clock_now_us(app->clock);
+    if(!opensesame_radio_start(lane->radio, frequency, periods[r], lane->chunk, lane->bytes)) {
+        OPENSESAME_EVENT(app, EventTxRefused, lane->index, frequency, 0);
+        return false;
+    }
+    OPENSESAME_EVENT(app, EventTxStart, lane->index, frequency, lane->radio->nominal_us);
+    if(lane->variant == 1) {
+        const OnAirChunk on_air = {
+            .target = lane->step->target_idx,
+            .codes = lane->codes.end - lane->codes.first,
+            .last_code = lane->last_code,
+        };
+        on_air_set(app, lane->index, &on_air);
+    }
+    app->variant_airtime_us[r] += airtime_us;
+    lane->step->airtime_us += airtime_us;
+    lane->step->setup_us += lane->radio->start_us - setup_start_us;
+    return true;
+}
+
+// Active steps no radio is sending wait through the airtime, shared out
+// when several radios are on air at once
+static void scheduler_charge_shared(Scheduler* sched, const AttackStep* sending, uint32_t airtime_us) {
+    for(uint8_t s = 0; s < STEP_SLOT_COUNT; s++) {
+        AttackStep* step = &sched->steps[s];
+        if(!step->active || step == sending) continue;
+        bool on_lane = false;
+        for(uint8_t l = 0; l < sched->lane_count; l++) {
+            on_lane |= (sched->lanes[l].step == step);
+        }
+        if(!on_lane) step->shared_us += airtime_us / sched->lane_count;
+    }
+}
+
+// Gap after each transmission, plus the chunk delay once every variant is out
+static void scheduler_advance(OpenSesameApp* app, RadioLane* lane) {
+    const TxTuning* tuning = opensesame_tuning(app);
+    lane->ready_tick = clock_now_ms(app->clock) + tuning->variant_gap_ms;
+    lane->step->gap_us += tuning->variant_gap_ms * 1000;
+    if(lane->variant < scheduler_variant_count(app, lane->step)) return;
+
+    if(app->attack_mode == AttackModeCompatibility) {
+        if((lane->step->sent - 1) % 10 == 0) {
+            lane->ready_tick += 1;
+            lane->step->yield_us += 1000;
+        }
+    } else {
+        lane->ready_tick += tuning->chunk_gap_ms;
+        lane->step->gap_us += tuning->chunk_gap_ms * 1000;
+    }
+    lane->step = NULL;
+}
+
+// Encodes the step's next chunk into 'chunk', noting which codes it holds
+static size_t scheduler_fill_chunk(
+    OpenSesameApp* app,
+    AttackStep* step,
+    uint8_t* chunk,
+    CodeRange* codes,
+    uint32_t* last_code) {
+    CodeBuffer* buffer = &app->code_buffer;
+    codes->first = buffer->pushed;
+    const size_t bytes = opensesame_step_fill_chunk(app, step, chunk);
+    codes->end = buffer->pushed;
+    if(codes->end != codes->first) {
+        *last_code = buffer->codes[(buffer->head + buffer->count - 1) % CODE_BUFFER_SIZE];
+    }
+    return bytes;
+}
+
+// Takes the next chunk of 'lane->step': the one encoded ahead if there is
+// one (swapping buffers, the radio is idle), otherwise encodes it now
+static void scheduler_load_chunk(OpenSesameApp* app, Scheduler* sched, RadioLane* lane) {
+    const uint8_t slot = lane->step - sched->steps;
+    EncodedChunk* next = &sched->next[slot];
+    if(next->ready) {
+        uint8_t* buffer = lane->chunk;
+        lane->chunk = next->buffer;
+        next->buffer = buffer;
+        lane->bytes = next->bytes;
+        lane->codes = next->codes;
+        lane->last_code = next->last_code;
+        next->ready = false;
+    } else {
+        OPENSESAME_SPAN_BEGIN(app, TraceSpanEncode, TraceTrackWorker, 0);
+        lane->bytes =
+            scheduler_fill_chunk(app, lane->step, lane->chunk, &lane->codes, &lane->last_code);
+        OPENSESAME_SPAN_END(app, TraceSpanEncode, TraceTrackWorker);
+    }
+    app->code_buffer.pending[slot].end = app->code_buffer.pending[slot].first;
+    lane->variant = 0;
+}
+
+// Encodes the step's following chunk while 'lane' is on air
+static void scheduler_encode_ahead(OpenSesameApp* app, Scheduler* sched, RadioLane* lane) {
+    const uint8_t slot = lane->step - sched->steps;
+    EncodedChunk* next = &sched->next[slot];
+    if(next->ready) return;
+    OPENSESAME_SPAN_BEGIN(app, TraceSpanEncode, TraceTrackWorker, 1);
+    next->bytes =
+        scheduler_fill_chunk(app, lane->step, next->buffer, &next->codes, &next->last_code);
+    OPENSESAME_SPAN_END(app, TraceSpanEncode, TraceTrackWorker);
+    app->code_buffer.pending[slot] = next->codes;
+    next->ready = true;
+}
+
+typedef struct {
+    OpenSesameApp* app;
+    Scheduler* sched;
+} PrefetchContext;
+
+static int32_t opensesame_prefetch_thread(void* context) {
+    PrefetchContext* ctx = (PrefetchContext*)context;
+    uint8_t plan_index;
+
+    while(!worker_stop_requested()) {
+        if(furi_message_queue_get(ctx->sched->prefetch_queue, &plan_index, FuriWaitForever) !=
+               FuriStatusOk ||
+           plan_index == PREFETCH_STOP) {
+            continue;
+        }
+        // Sequences planned elsewhere than RAM are not generated ahead
+        if(ctx->sched->plan->strategy[plan_index] != SequenceStrategyRam) continue;
+        opensesame_sequence_prefetch(ctx->app, ctx->sched->plan->target_idx[plan_index]);
+    }
+    return 0;
+}
+
+// Hands upcoming plan targets to the prefetch thread while its queue has room
+static void scheduler_post_prefetch(Scheduler* sched) {
+    if(sched->prefetch_queue == NULL) return;
+
+    while(sched->prefetch_posted < sched->plan->count) {
+        uint8_t plan_index = sched->prefetch_posted;
+        if(!sched->started[plan_index] &&
+           furi_message_queue_put(sched->prefetch_queue, &plan_index, 0) != FuriStatusOk) {
+            break; // Full: the thread is still busy, retry later
+        }
+        sched->prefetch_posted++;
+    }
+}
+
+static void scheduler_prefetch_start(OpenSesameApp* app, Scheduler* sched, PrefetchContext* ctx) {
+    // Only de Bruijn steps need sequences, and a lone target has nothing to overlap
+    if(app->attack_mode != AttackModeDeBruijn || sched->plan->count < 2) return;
+
+    ctx->app = app;
+    ctx->sched = sched;
+    sched->prefetch_queue = furi_message_queue_alloc(PREFETCH_QUEUE_DEPTH, sizeof(uint8_t));
+    sched->prefetch_thread =
+        furi_thread_alloc_ex("OpenSesamePrefetch", 2048, opensesame_prefetch_thread, ctx);
+    if(sched->prefetch_queue == NULL || sched->prefetch_thread == NULL) {
+        FURI_LOG_W("OpenSesame", "Prefetch unavailable, generating inline");
+        if(sched->prefetch_thread != NULL) furi_thread_free(sched->prefetch_thread);
+        if(sched->prefetch_queue != NULL) furi_message_queue_free(sched->prefetch_queue);
+        sched->prefetch_thread = NULL;
+        sched->prefetch_queue = NULL;
+        return;
+    }
+    // Below the worker, so it only runs while the worker waits on the radio
+    furi_thread_set_priority(sched->prefetch_thread, FuriThreadPriorityNormal);
+    furi_thread_start(sched->prefetch_thread);
+}
+
+static void scheduler_prefetch_stop(Scheduler* sched) {
+    if(sched->prefetch_thread == NULL) return;
+    furi_thread_flags_set(furi_thread_get_id(sched->prefetch_thread), WORKER_EVENT_STOP);
+
+    // A full queue means the thread is busy and sees the flag by itself
+    const uint8_t wake = PREFETCH_STOP;
+    furi_message_queue_put(sched->prefetch_queue, &wake, 0);
+    furi_thread_join(sched->prefetch_thread);
+    furi_thread_free(sched->prefetch_thread);
+    furi_message_queue_free(sched->prefetch_queue);
+    sched->prefetch_thread = NULL;
+    sched->prefetch_queue = NULL;
+}
+
+// --- Long-Run Forecast ---
+// Work left is shared by the radios, but a restricted band cannot go
+// faster than its duty cycle once its remaining airtime budget is spent
+static uint64_t scheduler_remaining_wall_us(const OpenSesameApp* app, const Scheduler* sched) {
+    uint64_t work_us = 0;
+    uint64_t band_airtime_us[DUTY_BAND_COUNT] = {0};
+
+    for(uint8_t i = 0; i < sched->plan->count + STEP_SLOT_COUNT; i++) {
+        const OpenSesameTarget* target;
+        uint32_t units = 1, left = 1; // Share of the target still to send
+        if(i < sched->plan->count) {
+            if(sched->started[i]) continue;
+            target = &opensesame_targets[sched->plan->target_idx[i]];
+        } else {
+            const AttackStep* step = &sched->steps[i - sched->plan->count];
+            if(!step->active) continue;
+            target = step->target;
+            units = (app->attack_mode == AttackModeDeBruijn) ? step->total_digits : step->num_codes;
+            left = (units > step->sent) ? units - step->sent : 0;
+        }
+
+        work_us += opensesame_estimate_target_wall_us(app, target) * left / units;
+        const uint8_t band = duty_band_for_frequency(target->frequency);
+        if(band != DUTY_BAND_NONE) {
+            band_airtime_us[band] += opensesame_estimate_target_airtime_us(app, target) * left / units;
         }
-        free(seen);
+    }
 
-        const uint32_t total_digits = num_codes + (n - 1);
-        const size_t digits_per_chunk = PAYLOADS_PER_CHUNK;
-        const size_t bits_per_chunk = current_target->length * digits_per_chunk;
-        const size_t bytes_per_chunk = (bits_per_chunk + 7) / 8;
+    uint64_t wall_us = work_us / MAX(sched->lane_count, 1);
+    for(uint8_t b = 0; b < DUTY_BAND_COUNT; b++) {
+        const uint32_t available_us = airtime_governor_available_us(&app->governor, b);
+        if(band_airtime_us[b] <= available_us) continue;
+        const uint64_t duty_us =
+            (band_airtime_us[b] - available_us) * 1000 / duty_bands[b].duty_permille;
+        wall_us = MAX(wall_us, duty_us);
+    }
+    return wall_us;
+}
+
+// Fits the rest of the plan into 'budget_us': targets not yet started go
+// cheapest first, so as many as possible complete on the charge left, and
+// the most expensive are dropped until the remainder fits. Entries already
+// handed to the prefetch thread keep their place.
+static void scheduler_trim_plan(OpenSesameApp* app, Scheduler* sched, uint64_t budget_us) {
+    AttackPlan* plan = sched->plan;
+    uint8_t open[PLAN_MAX_STEPS]; // Plan positions that may still move
+    uint64_t wall_us[PLAN_MAX_STEPS];
+    uint8_t count = 0;
+    for(uint8_t p = sched->prefetch_posted; p < plan->count; p++) {
+        if(sched->started[p]) continue;
+        open[count] = p;
+        wall_us[count++] =
+            opensesame_estimate_target_wall_us(app, &opensesame_targets[plan->target_idx[p]]);
+    }
+    for(uint8_t i = 1; i < count; i++) {
+        for(uint8_t j = i; j > 0 && wall_us[j - 1] > wall_us[j]; j--) {
+            uint64_t wall = wall_us[j];
+            wall_us[j] = wall_us[j - 1];
+            wall_us[j - 1] = wall;
+            uint8_t target = plan->target_idx[open[j]];
+            plan->target_idx[open[j]] = plan->target_idx[open[j - 1]];
+            plan->target_idx[open[j - 1]] = target;
+            uint8_t strategy = plan->strategy[open[j]];
+            plan->strategy[open[j]] = plan->strategy[open[j - 1]];
+            plan->strategy[open[j - 1]] = strategy;
+        }
+    }
 
-        FURI_LOG_I("OpenSesame", "Starting transmission of %lu digits", total_digits);
+    for(uint8_t i = count; i > 0 && scheduler_remaining_wall_us(app, sched) > budget_us; i--) {
+        const uint8_t p = open[i - 1];
+        sched->started[p] = true; // Never picked
+        sched->pending--;
+        app->forecast.trimmed++;
+        OPENSESAME_EVENT(app, EventStepTrim, plan->target_idx[p], wall_us[i - 1] / 1000000, 0);
+        FURI_LOG_W(
+            "OpenSesame", "Battery short, dropping %s", opensesame_targets[plan->target_idx[p]].name);
+    }
+}
 
-        uint8_t* chunk_buffer = malloc(bytes_per_chunk);
-        if(chunk_buffer == NULL) {
-            FURI_LOG_E("OpenSesame", "Failed to allocate chunk buffer");
-            free(sequence);
-            return -1;
+// Samples the fuel gauge and re-forecasts the rest of the run
+static void scheduler_long_run_update(OpenSesameApp* app, Scheduler* sched, uint32_t now) {
+    PowerForecast* forecast = &app->forecast;
+
+    if(now - forecast->last_sample_tick >= LONG_RUN_SAMPLE_MS) {
+        forecast->last_sample_tick = now;
+        forecast->charging = furi_hal_power_is_charging();
+        if(!forecast->charging) {
+            const float current = furi_hal_power_get_battery_current(FuriHalPowerICFuelGauge);
+            forecast->current_sum_ma += (uint32_t)(fabsf(current) * 1000.0f);
+            forecast->samples++;
         }
+    }
+    if(now - forecast->last_forecast_tick < LONG_RUN_FORECAST_MS || forecast->samples == 0) return;
+    forecast->last_forecast_tick = now;
+
+    const uint32_t remaining_mah = furi_hal_power_get_battery_remaining_capacity();
+    const uint32_t reserve_mah =
+        furi_hal_power_get_battery_full_capacity() * LONG_RUN_RESERVE_PERMILLE / 1000;
+    forecast->average_ma = MAX(forecast->current_sum_ma / forecast->samples, 1ULL);
+    forecast->usable_mah = (remaining_mah > reserve_mah) ? remaining_mah - reserve_mah : 0;
+    forecast->needed_mah =
+        (uint64_t)forecast->average_ma * scheduler_remaining_wall_us(app, sched) / 3600000000ULL;
+    forecast->shortfall = !forecast->charging && forecast->needed_mah > forecast->usable_mah;
+    OPENSESAME_EVENT(
+        app, EventForecast, forecast->shortfall, forecast->needed_mah, forecast->usable_mah);
+
+    // A single target is never dropped, the forecast only warns
+    if(forecast->shortfall && sched->is_meta) {
+        scheduler_trim_plan(
+            app, sched, (uint64_t)forecast->usable_mah * 3600000000ULL / forecast->average_ma);
+    }
+}
+
+static int32_t opensesame_run_plan(OpenSesameApp* app, AttackPlan* plan, RadioSet* radios) {
+    int32_t result = 0;
+
+    Scheduler* sched = malloc(sizeof(Scheduler));
+    AttackStep* steps = malloc(sizeof(AttackStep) * STEP_SLOT_COUNT);
+    uint8_t* chunks = malloc(CHUNK_BUFFER_SIZE * (radios->count + STEP_SLOT_COUNT));
+    if(sched == NULL || steps == NULL || chunks == NULL) {
+        FURI_LOG_E("OpenSesame", "Failed to allocate scheduler buffers");
+        free(sched);
+        free(steps);
+        free(chunks);
+        return -1;
+    }
+    memset(sched, 0, sizeof(Scheduler));
+    memset(steps, 0, sizeof(AttackStep) * STEP_SLOT_COUNT);
+
+    sched->plan = plan;
+    sched->steps = steps;
+    sched->pending = plan->count;
+    sched->is_meta = opensesame_is_meta_target(app->current_target_index);
+    sched->lane_count = radios->count;
+    for(uint8_t l = 0; l < sched->lane_count; l++) {
+        sched->lanes[l].radio = &radios->radios[l];
+        sched->lanes[l].index = l;
+        sched->lanes[l].chunk = chunks + (CHUNK_BUFFER_SIZE * l);
+        sched->lanes[l].last_slot = DUTY_BAND_COUNT + l;
+    }
+    for(uint8_t s = 0; s < STEP_SLOT_COUNT; s++) {
+        sched->next[s].buffer = chunks + (CHUNK_BUFFER_SIZE * (sched->lane_count + s));
+    }
 
-        memset(chunk_buffer, 0, bytes_per_chunk);
-        size_t bit_offset = 0;
-        uint32_t code_register = 0;
+    PrefetchContext prefetch;
+    scheduler_prefetch_start(app, sched, &prefetch);
+
+    while(!(furi_thread_flags_get() & WORKER_EVENT_STOP)) {
+        uint32_t min_wait_ms = UINT32_MAX;
+        uint32_t now = clock_now_ms(app->clock);
+        if(app->long_run) scheduler_long_run_update(app, sched, now);
+        scheduler_post_prefetch(sched);
+
+        // 1. Every radio that is off the air gets its next transmission.
+        // Paused: nothing new starts, the radios and steps stay as they are.
+        for(uint8_t l = 0; l < sched->lane_count && !app->paused; l++) {
+            RadioLane* lane = &sched->lanes[l];
+            if(lane->radio->busy || (int32_t)(lane->ready_tick - now) > 0) continue;
+
+            if(lane->step == NULL) {
+                StepBeginResult pick = scheduler_pick(app, sched, l, &min_wait_ms);
+                if(pick == StepBeginStopped) goto done;
+                if(pick == StepBeginFailed) {
+                    result = -1;
+                    goto done;
+                }
+                if(pick != StepBeginOk) {
+                    // Throttled or out of work for a while: power the radio down
+                    if(app->long_run && min_wait_ms >= LONG_RUN_SLEEP_MIN_MS) {
+                        opensesame_radio_sleep(lane->radio);
+                    }
+                    continue;
+                }
 
-        for(uint32_t i = 0; i < total_digits; i++) {
-            if(i % 10 == 0) {
-                if(furi_thread_flags_get() & WORKER_EVENT_STOP) {
-                    free(chunk_buffer);
-                    free(sequence);
-                    return 0;
+                app->current_attack_target_idx = lane->step->target_idx; // For saving
+                scheduler_load_chunk(app, sched, lane);
+                if(lane->bytes == 0) {
+                    OPENSESAME_EVENT(
+                        app, EventStepEnd, lane->step->target_idx, lane->step->sent, 0);
+                    OPENSESAME_SPAN_END(
+                        app, TraceSpanStep, TraceTrackStep + (lane->step - sched->steps));
+                    opensesame_step_end(app, lane->step);
+                    lane->step = NULL;
+                    if(app->long_run) opensesame_radio_sleep(lane->radio);
+
+                    // Delay between targets in meta-modes
+                    if(sched->is_meta && sched->pending > 0) {
+                        lane->ready_tick = now + opensesame_tuning(app)->target_gap_ms;
+                    }
+                    continue;
                 }
             }
+            if(lane->variant == 0 && !scheduler_charge_chunk(app, lane, &min_wait_ms)) continue;
+            if(!scheduler_send_variant(app, lane)) {
+                scheduler_advance(app, lane);
+                continue;
+            }
+            scheduler_charge_shared(sched, lane->step, lane->radio->nominal_us);
+            if(lane->variant == 1) scheduler_encode_ahead(app, sched, lane);
+        }
+
+        // Hits marked since are written while the radios are on air
+        history_flush_hit(&app->history);
+
+        // 2. Wait for the radio that finishes first, the others keep sending
+        RadioLane* soonest = NULL;
+        uint32_t soonest_us = UINT32_MAX;
+        uint32_t gap_ms = UINT32_MAX;
+        for(uint8_t l = 0; l < sched->lane_count; l++) {
+            RadioLane* lane = &sched->lanes[l];
+            if(!lane->radio->busy) {
+                int32_t gap = (int32_t)(lane->ready_tick - now);
+                if(gap > 0 && (uint32_t)gap < gap_ms) gap_ms = gap;
+                continue;
+            }
+            uint32_t remaining_us = opensesame_radio_remaining_us(lane->radio);
+            if(remaining_us < soonest_us) {
+                soonest_us = remaining_us;
+                soonest = lane;
+            }
+        }
 
-            uint32_t digit_idx = i % num_codes;
-            uint8_t digit = sequence[digit_idx];
+        // An idle radio whose gap ends first starts before this chunk is out
+        if(soonest != NULL && gap_ms != UINT32_MAX && gap_ms * 1000 < soonest_us) {
+            OPENSESAME_SPAN_BEGIN(app, TraceSpanSleep, TraceTrackWorker, gap_ms);
+            clock_sleep_ms(app->clock, gap_ms);
+            OPENSESAME_SPAN_END(app, TraceSpanSleep, TraceTrackWorker);
+            continue;
+        }
 
-            if(i < n) {
-                code_register = (code_register * k) + digit;
-            } else {
-                code_register = ((code_register % divisor) * k) + digit;
+        if(soonest != NULL) {
+            app->duty_waiting = false;
+            OPENSESAME_SPAN_BEGIN(app, TraceSpanRadioWait, TraceTrackWorker, soonest->index);
+            bool finished = opensesame_radio_finish(soonest->radio, &app->jitter);
+            OPENSESAME_SPAN_END(app, TraceSpanRadioWait, TraceTrackWorker);
+            if(!finished) break;
+            OPENSESAME_EVENT(app, EventTxEnd, soonest->index, soonest->radio->elapsed_us,
+                soonest->radio->nominal_us);
+            if(soonest->radio->elapsed_us > soonest->radio->nominal_us) {
+                soonest->step->setup_us += soonest->radio->elapsed_us - soonest->radio->nominal_us;
             }
+            scheduler_advance(app, soonest);
+            continue;
+        }
 
-            if(i >= (uint32_t)(n - 1)) {
-                app->current_code = code_register;
-                app->codes_transmitted++;
-                opensesame_push_code_to_buffer(app, code_register);
+        // 3. Nothing on air: finished, pausing, in a gap or throttled
+        bool any_active = false;
+        uint32_t wait = UINT32_MAX;
+        for(uint8_t s = 0; s < STEP_SLOT_COUNT; s++) {
+            any_active |= steps[s].active;
+        }
+        for(uint8_t l = 0; l < sched->lane_count; l++) {
+            int32_t gap = (int32_t)(sched->lanes[l].ready_tick - now);
+            if(gap > 0 && (uint32_t)gap < wait) wait = gap;
+        }
+        if(!any_active && sched->pending == 0 && wait == UINT32_MAX) break; // Plan finished
+
+        bool idle = true; // Not a gap: the active steps cannot use the time
+        if(app->paused) {
+            app->duty_waiting = false;
+            wait = 50;
+        } else if(wait == UINT32_MAX || min_wait_ms < wait) {
+            // Every candidate band is throttled: idle until the soonest refill
+            wait = (min_wait_ms == UINT32_MAX) ? 100 : min_wait_ms;
+            if(!app->duty_waiting) OPENSESAME_EVENT(app, EventDutyWait, 0, wait, 0);
+            app->duty_waiting = true;
+        } else {
+            idle = false;
+        }
+        wait = CLAMP(wait, 100UL, 1UL);
+        if(app->long_run && wait >= LONG_RUN_SLEEP_MIN_MS) {
+            for(uint8_t l = 0; l < sched->lane_count; l++) {
+                opensesame_radio_sleep(sched->lanes[l].radio);
             }
+        }
+        const uint64_t sleep_start_us = clock_now_us(app->clock);
+        OPENSESAME_SPAN_BEGIN(app, TraceSpanSleep, TraceTrackWorker, wait);
+        clock_sleep_ms(app->clock, wait);
+        OPENSESAME_SPAN_END(app, TraceSpanSleep, TraceTrackWorker);
+        for(uint8_t s = 0; s < STEP_SLOT_COUNT && idle; s++) {
+            if(steps[s].active) steps[s].idle_us += clock_now_us(app->clock) - sleep_start_us;
+        }
+    }
+
+done:
+    scheduler_prefetch_stop(sched);
+    for(uint8_t l = 0; l < sched->lane_count; l++) {
+        RadioSession* radio = sched->lanes[l].radio;
+        if(radio->busy) {
+            radio->backend->stop_tx(radio);
+            radio->busy = false;
+        }
+    }
+    for(uint8_t s = 0; s < STEP_SLOT_COUNT; s++) {
+        if(steps[s].active) OPENSESAME_SPAN_END(app, TraceSpanStep, TraceTrackStep + s);
+        opensesame_step_end(app, &steps[s]);
+    }
+    FURI_LOG_I("OpenSesame", "TX timing: %lu chunks, worst error %lu us",
+        app->jitter.chunks, app->jitter.worst_us);
+    FURI_LOG_I("OpenSesame", "Sequence cache: %lu hits, %lu misses, %u bytes, "
+        "%u from packs (%lu bytes read, %u damaged blocks)",
+        app->sequence_cache.hits, app->sequence_cache.misses, app->sequence_cache.bytes,
+        app->sequence_cache.pack_loads, app->sequence_cache.pack_bytes_read,
+        app->sequence_cache.pack_damaged);
+    if(app->attack_mode == AttackModeDeBruijn) {
+        FURI_LOG_I("OpenSesame", "Step strategies: %u cache, %u ram, %u pack, %u stream",
+            app->strategy_steps[SequenceStrategyCache], app->strategy_steps[SequenceStrategyRam],
+            app->strategy_steps[SequenceStrategyPack], app->strategy_steps[SequenceStrategyStream]);
+    }
+
+    uint8_t period_count;
+    const uint16_t* periods = opensesame_bit_periods(app, &period_count);
+    for(uint8_t r = 0; r < period_count; r++) {
+        FURI_LOG_I("OpenSesame", "Airtime at %uus: %lu ms",
+            periods[r], (uint32_t)(app->variant_airtime_us[r] / 1000));
+    }
+    free(sched);
+    free(steps);
+    free(chunks);
+    app->duty_waiting = false;
+    return result;
+}
 
-            bit_offset = opensesame_append_digit_pattern(digit, current_target, chunk_buffer, bit_offset);
+// --- Job Queue ---
+static void opensesame_job_capture(const OpenSesameApp* app, OpenSesameJob* job) {
+    job->target_index = app->current_target_index;
+    job->attack_mode = app->attack_mode;
+    job->options = (app->drift_sweep ? JobOptionDriftSweep : 0) |
+                   (app->rate_sweep ? JobOptionRateSweep : 0);
+}
+
+static void opensesame_job_apply(OpenSesameApp* app, const OpenSesameJob* job) {
+    app->current_target_index = job->target_index;
+    app->attack_mode = (AttackMode)job->attack_mode;
+    app->drift_sweep = (job->options & JobOptionDriftSweep) != 0;
+    app->rate_sweep = (job->options & JobOptionRateSweep) != 0;
+}
+
+static bool opensesame_job_valid(const OpenSesameJob* job) {
+    return job->target_index < opensesame_target_count && job->attack_mode < AttackModeCount &&
+           (job->options & ~(JobOptionDriftSweep | JobOptionRateSweep)) == 0;
+}
+
+static bool job_queue_save(const OpenSesameApp* app) {
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+    FlipperFormat* ff = flipper_format_file_alloc(storage);
+
+    uint32_t count = app->job_count;
+    uint32_t targets[JOB_QUEUE_MAX], modes[JOB_QUEUE_MAX], options[JOB_QUEUE_MAX];
+    for(uint8_t i = 0; i < app->job_count; i++) {
+        targets[i] = app->jobs[i].target_index;
+        modes[i] = app->jobs[i].attack_mode;
+        options[i] = app->jobs[i].options;
+    }
 
-            if((i + 1) % digits_per_chunk == 0) {
-                opensesame_transmit_raw(current_target->frequency, chunk_buffer, bytes_per_chunk);
-                memset(chunk_buffer, 0, bytes_per_chunk);
-                bit_offset = 0;
-                furi_delay_ms(5);
+    bool ok = flipper_format_file_open_always(ff, JOB_QUEUE_PATH) &&
+              flipper_format_write_header_cstr(ff, JOB_QUEUE_FILETYPE, JOB_QUEUE_VERSION) &&
+              flipper_format_write_comment_cstr(ff, "Options: 1 = drift sweep, 2 = rate sweep") &&
+              flipper_format_write_uint32(ff, "Count", &count, 1);
+    if(ok && count > 0) {
+        ok = flipper_format_write_uint32(ff, "Target", targets, count) &&
+             flipper_format_write_uint32(ff, "Mode", modes, count) &&
+             flipper_format_write_uint32(ff, "Options", options, count);
+    }
+
+    flipper_format_free(ff);
+    furi_record_close(RECORD_STORAGE);
+    FURI_LOG_I("OpenSesame", "Job queue save %s: %lu jobs", ok ? "ok" : "failed", count);
+    return ok;
+}
+
+// Replaces the queue only when the whole file parses; invalid jobs are dropped
+static bool job_queue_load(OpenSesameApp* app) {
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+    FlipperFormat* ff = flipper_format_file_alloc(storage);
+    FuriString* filetype = furi_string_alloc();
+
+    uint32_t version = 0;
+    uint32_t count = 0;
+    uint32_t targets[JOB_QUEUE_MAX], modes[JOB_QUEUE_MAX], options[JOB_QUEUE_MAX];
+
+    bool ok = flipper_format_file_open_existing(ff, JOB_QUEUE_PATH) &&
+              flipper_format_read_header(ff, filetype, &version) &&
+              furi_string_equal_str(filetype, JOB_QUEUE_FILETYPE) &&
+              version == JOB_QUEUE_VERSION && flipper_format_read_uint32(ff, "Count", &count, 1);
+    if(ok && count > JOB_QUEUE_MAX) count = JOB_QUEUE_MAX;
+    if(ok && count > 0) {
+        ok = flipper_format_read_uint32(ff, "Target", targets, count) &&
+             flipper_format_read_uint32(ff, "Mode", modes, count) &&
+             flipper_format_read_uint32(ff, "Options", options, count);
+    }
+
+    if(ok) {
+        app->job_count = 0;
+        for(uint32_t i = 0; i < count; i++) {
+            OpenSesameJob job = {
+                .target_index = (uint8_t)targets[i],
+                .attack_mode = (uint8_t)modes[i],
+                .options = (uint8_t)options[i],
+            };
+            if(targets[i] > UINT8_MAX || modes[i] > UINT8_MAX || options[i] > UINT8_MAX ||
+               !opensesame_job_valid(&job)) {
+                FURI_LOG_W("OpenSesame", "Skipping invalid job %lu", i);
+                continue;
             }
+            app->jobs[app->job_count++] = job;
         }
+    }
+
+    furi_string_free(filetype);
+    flipper_format_free(ff);
+    furi_record_close(RECORD_STORAGE);
+    FURI_LOG_I("OpenSesame", "Job queue load %s: %u jobs", ok ? "ok" : "failed", app->job_count);
+    return ok;
+}
+
+// --- Auto-Tuner ---
+// Calibration times this device on the running firmware and picks the
+// scheduler settings from it: gaps just long enough for the GUI to get a
+// turn, the shortest chunk whose setup and gaps stay within
+// TUNING_OVERHEAD_PERMILLE of its airtime, and the longest generation
+// stretch that still sees a stop within STOP_LATENCY_BOUND_MS. Results are
+// kept per device and only used on the firmware build that measured them.
+static void tuning_path(char* path, size_t path_size) {
+    const char* name = furi_hal_version_get_name_ptr();
+    snprintf(path, path_size, TUNING_PATH_FORMAT, (name != NULL) ? name : "unnamed");
+}
+
+static const char* tuning_firmware(void) {
+    const char* githash = version_get_githash(furi_hal_version_get_firmware_version());
+    return (githash != NULL) ? githash : "unknown";
+}
+
+static bool tuning_valid(const TxTuning* tuning) {
+    return (tuning->chunk_airtime_ms == 0 ||
+            (tuning->chunk_airtime_ms >= TUNING_CHUNK_AIRTIME_MIN_MS &&
+             tuning->chunk_airtime_ms <= TUNING_CHUNK_AIRTIME_MAX_MS)) &&
+           tuning->variant_gap_ms >= 1 && tuning->variant_gap_ms <= tuning_defaults.variant_gap_ms &&
+           tuning->chunk_gap_ms >= 1 && tuning->chunk_gap_ms <= tuning_defaults.chunk_gap_ms &&
+           tuning->target_gap_ms >= TUNING_TARGET_GAP_MIN_MS &&
+           tuning->target_gap_ms <= tuning_defaults.target_gap_ms &&
+           tuning->yield_digits >= TUNING_YIELD_DIGITS_MIN &&
+           tuning->yield_digits <= TUNING_YIELD_DIGITS_MAX;
+}
+
+static bool tuning_save(const TxTuning* tuning) {
+    char path[TUNING_PATH_SIZE];
+    tuning_path(path, sizeof(path));
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+    FlipperFormat* ff = flipper_format_file_alloc(storage);
+
+    bool ok = flipper_format_file_open_always(ff, path) &&
+              flipper_format_write_header_cstr(ff, TUNING_FILETYPE, TUNING_VERSION) &&
+              flipper_format_write_comment_cstr(ff, "Written by Auto-Tune, used on this firmware only") &&
+              flipper_format_write_string_cstr(ff, "Firmware", tuning_firmware()) &&
+              flipper_format_write_uint32(ff, "Chunk_airtime_ms", &tuning->chunk_airtime_ms, 1) &&
+              flipper_format_write_uint32(ff, "Variant_gap_ms", &tuning->variant_gap_ms, 1) &&
+              flipper_format_write_uint32(ff, "Chunk_gap_ms", &tuning->chunk_gap_ms, 1) &&
+              flipper_format_write_uint32(ff, "Target_gap_ms", &tuning->target_gap_ms, 1) &&
+              flipper_format_write_uint32(ff, "Yield_digits", &tuning->yield_digits, 1) &&
+              flipper_format_write_uint32(ff, "Setup_us", &tuning->setup_us, 1) &&
+              flipper_format_write_uint32(ff, "Callback_ppm", &tuning->callback_ppm, 1) &&
+              flipper_format_write_uint32(ff, "Tick_us", &tuning->tick_us, 1) &&
+              flipper_format_write_uint32(ff, "Digit_ns", &tuning->digit_ns, 1) &&
+              flipper_format_write_uint32(ff, "UI_latency_us", &tuning->ui_latency_us, 1);
+
+    flipper_format_free(ff);
+    furi_record_close(RECORD_STORAGE);
+    FURI_LOG_I("OpenSesame", "Tuning save %s: %s", ok ? "ok" : "failed", path);
+    return ok;
+}
+
+// The defaults unless this device has a valid file from this firmware build
+static bool tuning_load(TxTuning* tuning) {
+    *tuning = tuning_defaults;
+
+    char path[TUNING_PATH_SIZE];
+    tuning_path(path, sizeof(path));
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+    FlipperFormat* ff = flipper_format_file_alloc(storage);
+    FuriString* filetype = furi_string_alloc();
+    FuriString* firmware = furi_string_alloc();
+
+    TxTuning loaded = tuning_defaults;
+    uint32_t version = 0;
+    bool ok = flipper_format_file_open_existing(ff, path) &&
+              flipper_format_read_header(ff, filetype, &version) &&
+              furi_string_equal_str(filetype, TUNING_FILETYPE) && version == TUNING_VERSION &&
+              flipper_format_read_string(ff, "Firmware", firmware) &&
+              flipper_format_read_uint32(ff, "Chunk_airtime_ms", &loaded.chunk_airtime_ms, 1) &&
+              flipper_format_read_uint32(ff, "Variant_gap_ms", &loaded.variant_gap_ms, 1) &&
+              flipper_format_read_uint32(ff, "Chunk_gap_ms", &loaded.chunk_gap_ms, 1) &&
+              flipper_format_read_uint32(ff, "Target_gap_ms", &loaded.target_gap_ms, 1) &&
+              flipper_format_read_uint32(ff, "Yield_digits", &loaded.yield_digits, 1) &&
+              flipper_format_read_uint32(ff, "Setup_us", &loaded.setup_us, 1) &&
+              flipper_format_read_uint32(ff, "Callback_ppm", &loaded.callback_ppm, 1) &&
+              flipper_format_read_uint32(ff, "Tick_us", &loaded.tick_us, 1) &&
+              flipper_format_read_uint32(ff, "Digit_ns", &loaded.digit_ns, 1) &&
+              flipper_format_read_uint32(ff, "UI_latency_us", &loaded.ui_latency_us, 1);
+
+    if(ok && !furi_string_equal_str(firmware, tuning_firmware())) {
+        FURI_LOG_W("OpenSesame", "Tuning is for firmware %s, using defaults",
+            furi_string_get_cstr(firmware));
+        ok = false;
+    } else if(ok && !tuning_valid(&loaded)) {
+        FURI_LOG_W("OpenSesame", "Tuning out of range, using defaults");
+        ok = false;
+    }
+    if(ok) *tuning = loaded;
+
+    furi_string_free(firmware);
+    furi_string_free(filetype);
+    flipper_format_free(ff);
+    furi_record_close(RECORD_STORAGE);
+    FURI_LOG_I("OpenSesame", "Tuning load %s: chunk %lu ms, gaps %lu/%lu/%lu ms, yield %lu",
+        ok ? "ok" : "skipped", tuning->chunk_airtime_ms, tuning->variant_gap_ms,
+        tuning->chunk_gap_ms, tuning->target_gap_ms, tuning->yield_digits);
+    return ok;
+}
+
+// Sorts the few samples in place
+static uint32_t tuning_median(uint32_t* samples, uint8_t count) {
+    for(uint8_t i = 1; i < count; i++) {
+        const uint32_t value = samples[i];
+        uint8_t j = i;
+        for(; j > 0 && samples[j - 1] > value; j--) samples[j] = samples[j - 1];
+        samples[j] = value;
+    }
+    return samples[count / 2];
+}
+
+// Restricted bands wait for the governor like the scheduler does.
+// Returns false if the worker was told to stop first.
+static bool tuning_wait_budget(OpenSesameApp* app, uint8_t band, uint32_t airtime_us) {
+    uint32_t wait_ms;
+    while((wait_ms = airtime_governor_wait_ms(&app->governor, band, airtime_us)) > 0) {
+        app->duty_waiting = true;
+        if(clock_sleep_ms(app->clock, CLAMP(wait_ms, 100UL, 1UL))) return false;
+    }
+    app->duty_waiting = false;
+    return true;
+}
 
-        if(bit_offset > 0) {
-            size_t final_bytes = (bit_offset + 7) / 8;
-            opensesame_transmit_raw(current_target->frequency, chunk_buffer, final_bytes);
+// Sends 'digits' zero digits of 'target' TUNING_SAMPLES times. Puts the
+// median wall time beyond their airtime in 'overhead_us' and, if the GUI
+// answered the pings sent along, its median turnaround in 'latency_us'.
+static bool tuning_time_tx(
+    OpenSesameApp* app,
+    RadioSession* radio,
+    const OpenSesameTarget* target,
+    uint8_t* chunk,
+    uint32_t digits,
+    uint32_t* overhead_us,
+    uint32_t* latency_us) {
+    memset(chunk, 0, CHUNK_BUFFER_SIZE);
+    size_t bit_offset = 0;
+    for(uint32_t d = 0; d < digits; d++) {
+        bit_offset = opensesame_append_digit_pattern(0, target, chunk, bit_offset);
+    }
+    const size_t bytes = (bit_offset + 7) / 8;
+    const uint8_t band = duty_band_for_frequency(target->frequency);
+
+    uint32_t overheads[TUNING_SAMPLES];
+    uint32_t latencies[TUNING_SAMPLES];
+    uint8_t answered = 0;
+    for(uint8_t s = 0; s < TUNING_SAMPLES; s++) {
+        if(!tuning_wait_budget(app, band, bytes * 8 * BIT_PERIOD_US)) return false;
+
+        // Answered on the GUI thread while this worker waits for the radio
+        app->tune_latency_us = 0;
+        app->tune_ping_us = (uint32_t)clock_now_us(app->clock);
+        view_dispatcher_send_custom_event(app->view_dispatcher, OpenSesameEventTunePing);
+
+        while(!airtime_governor_charge(&app->governor, band, bytes * 8 * BIT_PERIOD_US)) {
+            if(!tuning_wait_budget(app, band, bytes * 8 * BIT_PERIOD_US)) return false;
         }
+        const uint64_t start_us = clock_now_us(app->clock);
+        if(!opensesame_radio_start(radio, target->frequency, BIT_PERIOD_US, chunk, bytes)) {
+            return false;
+        }
+        if(!opensesame_radio_finish(radio, &app->jitter)) return false;
+        const uint64_t wall_us = clock_now_us(app->clock) - start_us;
 
-        free(chunk_buffer);
-        free(sequence);
-        
-        FURI_LOG_I("OpenSesame", "Completed target %d", target_idx);
-        
-        // Delay between targets in meta-modes
-        if((is_all_known || is_generic_brute || is_european_brute) && target_idx < target_end) {
-            // Don't delay if the next target is a meta-target we're skipping
-            if(target_idx + 1 != 4 && target_idx + 1 != 5 && target_idx + 1 != 6) {
-                furi_delay_ms(100);
-            }
+        overheads[s] = (wall_us > radio->nominal_us) ? wall_us - radio->nominal_us : 0;
+        if(app->tune_latency_us != 0) latencies[answered++] = app->tune_latency_us;
+        app->tune_ping_us = 0;
+        clock_delay_ms(app->clock, tuning_defaults.variant_gap_ms);
+    }
+
+    *overhead_us = tuning_median(overheads, TUNING_SAMPLES);
+    if(answered > 0) *latency_us = tuning_median(latencies, answered);
+    return true;
+}
+
+static void tuning_pick(TxTuning* tuning) {
+    // The raised worker leaves the CPU to the GUI in its gaps: one event
+    // turnaround each, never more than the original gaps
+    const uint32_t ui_us = (tuning->ui_latency_us != 0) ? tuning->ui_latency_us : tuning->tick_us;
+    const uint32_t gap_ms = CLAMP((ui_us + 999) / 1000, tuning_defaults.variant_gap_ms, 1UL);
+    tuning->variant_gap_ms = gap_ms;
+    tuning->chunk_gap_ms = gap_ms;
+    tuning->target_gap_ms = MAX(gap_ms, (uint32_t)TUNING_TARGET_GAP_MIN_MS);
+
+    // Generation between two yields, and the yield itself, within the bound
+    tuning->yield_digits = TUNING_YIELD_DIGITS_MAX;
+    while(tuning->yield_digits > TUNING_YIELD_DIGITS_MIN &&
+          (uint64_t)tuning->yield_digits * tuning->digit_ns / 1000 + tuning->tick_us >
+              STOP_LATENCY_BOUND_MS * 1000) {
+        tuning->yield_digits /= 2;
+    }
+
+    // Setup and both gaps once per chunk; what the callbacks add per unit
+    // of airtime no chunk length saves, so it comes off the budget
+    const uint32_t budget_ppm = TUNING_OVERHEAD_PERMILLE * 1000;
+    const uint32_t left_ppm = MAX(budget_ppm - MIN(tuning->callback_ppm, budget_ppm), budget_ppm / 4);
+    const uint64_t fixed_us = tuning->setup_us + (uint64_t)gap_ms * 2 * 1000;
+    const uint64_t chunk_ms = (fixed_us * 1000 + left_ppm - 1) / left_ppm;
+    tuning->chunk_airtime_ms =
+        CLAMP(chunk_ms, (uint64_t)TUNING_CHUNK_AIRTIME_MAX_MS, (uint64_t)TUNING_CHUNK_AIRTIME_MIN_MS);
+}
+
+// Worker run of the Auto-Tune entry: measures on the plan's first target
+// on an unrestricted band, picks the settings and keeps them for this device
+static int32_t opensesame_calibrate(OpenSesameApp* app, RadioSet* radios) {
+    AttackPlan* plan = malloc(sizeof(AttackPlan));
+    uint8_t* chunk = malloc(CHUNK_BUFFER_SIZE);
+    if(plan == NULL || chunk == NULL) {
+        FURI_LOG_E("OpenSesame", "Failed to allocate calibration buffers");
+        free(plan);
+        free(chunk);
+        return -1;
+    }
+    opensesame_plan_build(app, plan);
+    const OpenSesameTarget* target = &opensesame_targets[plan->target_idx[0]];
+    for(uint8_t i = 0; i < plan->count; i++) {
+        const OpenSesameTarget* candidate = &opensesame_targets[plan->target_idx[i]];
+        if(duty_band_for_frequency(candidate->frequency) == DUTY_BAND_NONE) {
+            target = candidate;
+            break;
         }
     }
+    free(plan);
+    app->current_attack_target_idx = target - opensesame_targets;
+    app->tune_summary[0] = '\0';
+
+    TxTuning tuning = tuning_defaults;
+    RadioSession* radio = &radios->radios[0];
+    const uint32_t long_digits = MIN(TUNING_LONG_DIGITS, CHUNK_BYTES_MAX * 8 / target->length);
+    uint32_t short_us = 0, long_us = 0, unused = 0;
+    bool ok = tuning_time_tx(app, radio, target, chunk, TUNING_SHORT_DIGITS, &short_us, &unused) &&
+              tuning_time_tx(app, radio, target, chunk, long_digits, &long_us, &tuning.ui_latency_us);
+
+    if(ok) {
+        // Setup is what a short chunk costs beyond its airtime; the longer
+        // chunk's extra cost grows with the airtime
+        const uint32_t short_nominal_us =
+            ((TUNING_SHORT_DIGITS * target->length + 7) / 8) * 8 * BIT_PERIOD_US;
+        const uint32_t long_nominal_us = ((long_digits * target->length + 7) / 8) * 8 * BIT_PERIOD_US;
+        tuning.setup_us = short_us;
+        if(long_us > short_us && long_nominal_us > short_nominal_us) {
+            tuning.callback_ppm =
+                (uint64_t)(long_us - short_us) * 1000000 / (long_nominal_us - short_nominal_us);
+        }
+
+        uint64_t start_us = clock_now_us(app->clock);
+        for(uint8_t s = 0; s < TUNING_SAMPLES; s++) {
+            clock_delay_ms(app->clock, 1);
+        }
+        tuning.tick_us = (clock_now_us(app->clock) - start_us) / TUNING_SAMPLES;
+
+        // Same work per digit as opensesame_debruijn_generate_packed, on a
+        // trinary order the size of the larger targets
+        DeBruijnStream stream;
+        debruijn_stream_init(&stream, 3, 9);
+        start_us = clock_now_us(app->clock);
+        for(uint32_t i = 0; i < TUNING_GENERATE_DIGITS; i++) {
+            opensesame_packed_set_digit(
+                chunk, i % (CHUNK_BUFFER_SIZE * 4), debruijn_stream_next(&stream));
+        }
+        tuning.digit_ns = (clock_now_us(app->clock) - start_us) * 1000 / TUNING_GENERATE_DIGITS;
 
-    FURI_LOG_I("OpenSesame", "de Bruijn attack completed");
+        ok = !(furi_thread_flags_get() & WORKER_EVENT_STOP);
+    }
+    free(chunk);
+    if(!ok) return -1; // Stopped: keep the settings in use
+
+    tuning_pick(&tuning);
+    app->tuning = tuning;
+    tuning_save(&tuning);
+    OPENSESAME_EVENT(
+        app, EventTuning, tuning.variant_gap_ms, tuning.chunk_airtime_ms, tuning.yield_digits);
+    snprintf(app->tune_summary, sizeof(app->tune_summary), "Chunk %lums gap %lums",
+        tuning.chunk_airtime_ms, tuning.variant_gap_ms);
+    FURI_LOG_I("OpenSesame",
+        "Tuned: setup %lu us, callbacks %lu ppm, tick %lu us, digit %lu ns, UI %lu us -> "
+        "chunk %lu ms, gap %lu ms, target gap %lu ms, yield %lu digits",
+        tuning.setup_us, tuning.callback_ppm, tuning.tick_us, tuning.digit_ns,
+        tuning.ui_latency_us, tuning.chunk_airtime_ms, tuning.variant_gap_ms,
+        tuning.target_gap_ms, tuning.yield_digits);
     return 0;
 }
 
 // --- Worker Thread ---
-static int32_t opensesame_worker_thread(void* context) {
-    if(context == NULL) return -1;
-    
-    OpenSesameApp* app = (OpenSesameApp*)context;
-    
+// Appends the steps that ran and the run record to the history
+static void opensesame_history_finish_run(OpenSesameApp* app, int32_t result) {
+    RunHistory* history = &app->history;
+    history_flush_hit(history);
+    if(history->run_steps == NULL) return;
+
+    OpenSesameJob job;
+    opensesame_job_capture(app, &job);
+
+    HistoryRecord* run = &history->run_steps[history->run_step_count];
+    memset(run, 0, sizeof(HistoryRecord));
+    for(uint8_t i = 0; i < history->run_step_count; i++) {
+        HistoryRecord* step = &history->run_steps[i];
+        const OpenSesameTarget* target = &opensesame_targets[step->target];
+        step->options = job.options;
+        step->estimate_ms = (uint32_t)(opensesame_estimate_target_airtime_us(app, target) / 1000);
+        run->airtime_ms += step->airtime_ms;
+        run->estimate_ms += step->estimate_ms;
+    }
+
+    run->type = HistoryRecordRun;
+    run->mode = app->attack_mode;
+    run->target = app->current_target_index;
+    run->status = HistoryStopCompleted;
+    if(furi_thread_flags_get() & WORKER_EVENT_STOP) {
+        run->status = HistoryStopUser;
+    } else if(result != 0) {
+        run->status = HistoryStopFailed;
+    }
+    run->run = history->run_id;
+    run->codes = app->codes_transmitted;
+    run->total = app->max_code;
+    run->wall_ms = clock_now_ms(app->clock) - history->run_start_ms;
+    run->steps = history->run_step_count;
+    run->radios = app->radio_count;
+    run->options = job.options;
+    if(!history_append(history, history->run_steps, history->run_step_count + 1)) {
+        FURI_LOG_W("OpenSesame", "Run history not written");
+    }
+
+    free(history->run_steps);
+    history->run_steps = NULL;
+}
+
+// Runs the app's current target, mode and options on an already open radio
+static int32_t opensesame_run_selection(OpenSesameApp* app, RadioSet* radios) {
     app->current_attack_target_idx = app->current_target_index;
+    app->current_code = 0;
+    app->codes_transmitted = 0;
     app->code_buffer.head = 0;
     app->code_buffer.count = 0;
+    memset(app->code_buffer.pending, 0, sizeof(app->code_buffer.pending));
+    for(uint8_t r = 0; r < RADIO_MAX; r++) {
+        on_air_set(app, r, &(OnAirChunk){0});
+    }
+    OPENSESAME_EVENT(
+        app, EventRunStart, app->attack_mode, app->current_target_index, app->radio_count);
+
+    // Dry runs and the stop benchmark are not recorded
+    RunHistory* history = &app->history;
+    const bool recorded = (app->clock == &app->device_clock) && !app->stop_bench;
+    history->run_id = furi_hal_rtc_get_timestamp();
+    history->run_start_ms = clock_now_ms(app->clock);
+    history->hit_marked = false;
+    history_ensure_loaded(history); // Before the plan, which puts targets with hits first
+
+    AttackPlan* plan = malloc(sizeof(AttackPlan));
+    if(plan == NULL) {
+        FURI_LOG_E("OpenSesame", "Failed to allocate attack plan");
+        return -1;
+    }
+    opensesame_plan_build(app, plan);
+    history->run_step_count = 0;
+    history->run_step_max = plan->count;
+    history->run_steps = recorded ? malloc((plan->count + 1) * sizeof(HistoryRecord)) : NULL;
+    opensesame_plan_pick_strategies(app, plan);
+    memset(app->strategy_steps, 0, sizeof(app->strategy_steps));
+    run_report_start(app);
 
     // max_code calculation
-    bool is_all_known = (app->current_target_index == 4);
-    bool is_generic_brute = (app->current_target_index == 5);
-    bool is_european_brute = (app->current_target_index == 6);
-    
-    if(is_all_known) {
-        app->max_code = 0;
-        // Check targets 0, 1, 2, 3
-        for(uint8_t i = 0; i < 4; i++) {
-            const OpenSesameTarget* t = &opensesame_targets[i];
-            const uint8_t n = t->bits;
-            const uint8_t k = t->trinary ? 3 : 2;
-            
-            // --- Logic to filter targets based on mode ---
-            if((!t->trinary && n > 13) || (t->trinary && n > 8)) {
-                if(app->attack_mode == AttackModeDeBruijn) continue; // Skip if too big for de Bruijn
-            }
-            if((!t->trinary && n > 31) || (t->trinary && n > 19)) {
-                 continue; // Skip if too large for pow()
-            }
-            app->max_code += (uint32_t)pow(k, n);
-        }
-        FURI_LOG_I("OpenSesame", "All Known mode, aggregate max_code: %lu", app->max_code);
+    app->max_code = 0;
+    for(uint8_t i = 0; i < plan->count; i++) {
+        const OpenSesameTarget* t = &opensesame_targets[plan->target_idx[i]];
+        app->max_code += (uint32_t)opensesame_target_code_count(t, app->attack_mode);
+    }
+    OPENSESAME_EVENT(app, EventPlan, plan->count, app->max_code, 0);
 
-    } else if (is_generic_brute) {
-        app->max_code = 0;
-        // Loop over *all generic* targets
-        for(uint8_t i = 0; i <= 67; i++) { // 0 to 67
-            if(i == 4 || i == 5 || i == 6) continue; // Skip meta-targets
-            
-            const OpenSesameTarget* t = &opensesame_targets[i];
-            const uint8_t n = t->bits;
-            const uint8_t k = t->trinary ? 3 : 2;
-            
-            // --- Logic to filter targets based on mode ---
-            if((!t->trinary && n > 13) || (t->trinary && n > 8)) {
-                if(app->attack_mode == AttackModeDeBruijn) continue; // Skip if too big for de Bruijn
-            }
-            if((!t->trinary && n > 31) || (t->trinary && n > 19)) {
-                 continue; // Skip if too large for pow()
-            }
-            app->max_code += (uint32_t)pow(k, n);
-        }
-        FURI_LOG_I("OpenSesame", "Generic Brute mode, aggregate max_code: %lu", app->max_code);
-
-    } else if (is_european_brute) {
-        app->max_code = 0;
-        // Loop over *all european* targets
-        for(uint8_t i = 68; i < opensesame_total_target_count; i++) { // 68 to 81
-            // No need to skip meta-targets here
-            const OpenSesameTarget* t = &opensesame_targets[i];
-            const uint8_t n = t->bits;
-            const uint8_t k = t->trinary ? 3 : 2;
-            
-            // --- Logic to filter targets based on mode ---
-            if((!t->trinary && n > 13) || (t->trinary && n > 8)) {
-                if(app->attack_mode == AttackModeDeBruijn) continue; // Skip if too big for de Bruijn
-            }
-            if((!t->trinary && n > 31) || (t->trinary && n > 19)) {
-                 continue; // Skip if too large for pow()
-            }
-            app->max_code += (uint32_t)pow(k, n);
-        }
-        FURI_LOG_I("OpenSesame", "European Brute mode, aggregate max_code: %lu", app->max_code);
+    int32_t result = opensesame_run_plan(app, plan, radios);
+    free(plan);
+    opensesame_history_finish_run(app, result);
+    run_report_finish(app);
 
-    } else {
-        // Single Target
-        const OpenSesameTarget* target = &opensesame_targets[app->current_target_index];
-        const uint8_t n = target->bits;
-        const uint8_t k = target->trinary ? 3 : 2;
-
-        if((!target->trinary && n > 31) || (target->trinary && n > 19)) {
-            FURI_LOG_W("OpenSesame", "Target bits (%d) too large, setting max_code to 0", n);
-            app->max_code = 0;
+    OPENSESAME_EVENT(app, EventRunEnd, 0, result, app->codes_transmitted);
+    return result;
+}
+
+// Jobs run back-to-back on one radio session; the user's selection is
+// restored afterwards so the menus still show what they picked
+static int32_t opensesame_run_queue(OpenSesameApp* app, RadioSet* radios) {
+    OpenSesameJob selection;
+    opensesame_job_capture(app, &selection);
+
+    uint32_t start_ms = clock_now_ms(app->clock);
+    uint32_t total_codes = 0;
+    uint8_t completed = 0;
+    uint8_t failed = 0;
+
+    for(uint8_t i = 0; i < app->job_count; i++) {
+        if(furi_thread_flags_get() & WORKER_EVENT_STOP) break;
+
+        app->job_index = i;
+        opensesame_job_apply(app, &app->jobs[i]);
+        OPENSESAME_EVENT(app, EventJobStart, i, app->jobs[i].target_index, app->jobs[i].attack_mode);
+        int32_t result = opensesame_run_selection(app, radios);
+        total_codes += app->codes_transmitted;
+
+        if(furi_thread_flags_get() & WORKER_EVENT_STOP) break;
+        if(result == 0) {
+            completed++;
         } else {
-            app->max_code = (uint32_t)pow(k, n);
+            failed++; // Unattended: log it and carry on with the next job
+            FURI_LOG_W("OpenSesame", "Job %u failed", i + 1);
         }
     }
 
-    const OpenSesameTarget* target = &opensesame_targets[app->current_target_index];
-    int32_t result = 0;
+    opensesame_job_apply(app, &selection);
+
+    uint64_t airtime_us = 0;
+    for(uint8_t r = 0; r < BIT_PERIOD_VARIANTS_MAX; r++) {
+        airtime_us += app->variant_airtime_us[r];
+    }
+    char airtime[16];
+    opensesame_format_duration(airtime, sizeof(airtime), airtime_us);
+    snprintf(app->queue_summary, sizeof(app->queue_summary), "Jobs %u/%u ok, %u fail, %s air",
+        completed, app->job_count, failed, airtime);
+    FURI_LOG_I("OpenSesame", "Queue: %u/%u jobs completed, %u failed, %lu codes, %lu ms wall, %s airtime",
+        completed, app->job_count, failed, total_codes, clock_now_ms(app->clock) - start_ms, airtime);
+
+    return (failed > 0) ? -1 : 0;
+}
+
+static int32_t opensesame_worker_thread(void* context) {
+    if(context == NULL) return -1;
+    
+    OpenSesameApp* app = (OpenSesameApp*)context;
+    
+    memset((void*)app->variant_airtime_us, 0, sizeof(app->variant_airtime_us));
+    memset(&app->jitter, 0, sizeof(app->jitter));
+    memset(&app->forecast, 0, sizeof(app->forecast));
+    app->queue_summary[0] = '\0';
+    app->paused = false;
+
+    // Dry run: the same setup on simulated radios, on a fresh virtual clock
+    // and governor so the real duty-cycle budget is left alone. Calibration
+    // always times the real device.
+    const bool dry_run = app->dry_run && !app->tune_run;
+    const bool simulated = dry_run || app->stop_bench; // Stop benchmark: real time
+    RadioSetup setup = app->radio_setup;
+    AirtimeGovernor governor = app->governor;
+    const uint32_t start_tick = furi_get_tick();
+    if(simulated) setup = opensesame_radio_setup_simulated(setup);
+    if(dry_run) {
+        clock_init(&app->virtual_clock, true);
+        app->clock = &app->virtual_clock;
+    }
+    if(simulated) airtime_governor_init(&app->governor, app->clock);
+
+    // Keep GUI, logging and storage from disturbing TX timing. Nothing is
+    // on air when simulated, and the other threads must get their turn:
+    // during a dry run's waits, and to watch a benchmarked worker.
+    FuriThreadPriority previous_priority = furi_thread_get_current_priority();
+    if(!simulated) furi_thread_set_current_priority(tx_priority_values[app->tx_priority]);
+
+    // Any key turns the backlight back on for the usual timeout
+    if(app->long_run) {
+        NotificationApp* notifications = furi_record_open(RECORD_NOTIFICATION);
+        notification_message(notifications, &sequence_display_backlight_off);
+        furi_record_close(RECORD_NOTIFICATION);
+    }
 
-    switch(app->attack_mode) {
-    case AttackModeCompatibility:
-        result = opensesame_worker_compatibility(app, target);
-        break;
-    case AttackModeStream:
-        result = opensesame_worker_stream(app, target);
-        break;
-    case AttackModeDeBruijn:
-        result = opensesame_worker_debruijn(app, target);
-        break;
-    default:
-        result = -1;
-        break;
+    RadioSet* radios = malloc(sizeof(RadioSet));
+    if(radios == NULL) {
+        FURI_LOG_E("OpenSesame", "Failed to allocate radios");
+        furi_thread_set_current_priority(previous_priority);
+        if(simulated) app->governor = governor;
+        app->clock = &app->device_clock;
+        app->is_attacking = false;
+        return -1;
+    }
+    OPENSESAME_SPAN_BEGIN(app, TraceSpanRadioSetup, TraceTrackWorker, setup);
+    opensesame_radios_begin(radios, setup, app->clock);
+    OPENSESAME_SPAN_END(app, TraceSpanRadioSetup, TraceTrackWorker);
+    app->radio_count = radios->count;
+
+    int32_t result = app->tune_run  ? opensesame_calibrate(app, radios) :
+                     app->queue_run ? opensesame_run_queue(app, radios) :
+                                      opensesame_run_selection(app, radios);
+
+    OPENSESAME_SPAN_BEGIN(app, TraceSpanRadioSetup, TraceTrackWorker, setup);
+    opensesame_radios_end(radios);
+    OPENSESAME_SPAN_END(app, TraceSpanRadioSetup, TraceTrackWorker);
+    free(radios);
+    furi_thread_set_current_priority(previous_priority);
+
+    if(dry_run) {
+        FURI_LOG_I(
+            "OpenSesame",
+            "Dry run: %lu ms simulated in %lu ms",
+            clock_now_ms(app->clock),
+            furi_get_tick() - start_tick);
+        app->clock = &app->device_clock;
     }
+    if(simulated) app->governor = governor;
 
     app->is_attacking = false;
     return result;
 }
 
+static bool opensesame_start_worker(OpenSesameApp* app) {
+    app->is_attacking = true;
+    app->current_code = 0;
+    app->codes_transmitted = 0;
+    app->attack_animation_index = 0;
+    app->worker_phase = WORKER_PHASE_SCHEDULING;
+    app->worker_thread = furi_thread_alloc_ex(
+        "OpenSesameWorker", 8192, opensesame_worker_thread, app);
+    if(app->worker_thread == NULL) {
+        FURI_LOG_E("OpenSesame", "Failed to allocate worker thread");
+        app->is_attacking = false;
+        return false;
+    }
+    furi_thread_start(app->worker_thread);
+    return true;
+}
+
+static void opensesame_stop_worker(OpenSesameApp* app) {
+    if(app->worker_thread == NULL) return;
+
+    FuriThreadId thread_id = furi_thread_get_id(app->worker_thread);
+    if(thread_id != NULL) {
+        furi_thread_flags_set(thread_id, WORKER_EVENT_STOP);
+    }
+    furi_thread_join(app->worker_thread); // Bounded by the worker's cancellation points
+    furi_thread_free(app->worker_thread);
+    app->worker_thread = NULL;
+    app->is_attacking = false;
+    app->paused = false;
+}
+
 // --- Attack Mode Input ---
 static bool attack_mode_input_callback(InputEvent* event, void* context);
 static void attack_mode_widget_setup(OpenSesameApp* app);
@@ -1279,7 +5735,7 @@ static bool attack_mode_input_callback(InputEvent* event, void* context) {
     }
 
     if(event->key == InputKeyOk) {
-        view_dispatcher_switch_to_view(app->view_dispatcher, ViewIdMenu);
+        opensesame_switch_to_view(app, ViewIdMenu);
         return true;
     }
 
@@ -1307,7 +5763,7 @@ static bool target_input_callback(InputEvent* event, void* context) {
     }
 
     if(event->key == InputKeyOk) {
-        view_dispatcher_switch_to_view(app->view_dispatcher, ViewIdMenu);
+        opensesame_switch_to_view(app, ViewIdMenu);
         return true;
     }
 
@@ -1388,10 +5844,62 @@ static void target_widget_setup(OpenSesameApp* app) {
         false);
 }
 
+static void attack_view_draw_telemetry(Canvas* canvas, OpenSesameApp* app) {
+    char info[64];
+    char airtime[16];
+    uint8_t period_count;
+    const uint16_t* periods = opensesame_bit_periods(app, &period_count);
+
+    // Airtime spent at each bit period variant this run
+    for(uint8_t r = 0; r < period_count; r++) {
+        opensesame_format_duration(airtime, sizeof(airtime), app->variant_airtime_us[r]);
+        snprintf(info, sizeof(info), "%4uus: %s", periods[r], airtime);
+        canvas_draw_str(canvas, 5, 22 + r * 8, info);
+    }
+
+    // Long-run forecast once the first one is in, below the last bit period
+    const PowerForecast* forecast = &app->forecast;
+    if(!app->long_run || forecast->average_ma == 0 || period_count >= BIT_PERIOD_VARIANTS_MAX) {
+        return;
+    }
+    snprintf(info, sizeof(info), "%u%% %lumA %lu/%lumAh %s", furi_hal_power_get_pct(),
+        forecast->average_ma, forecast->needed_mah, forecast->usable_mah,
+        forecast->charging ? "chg" : (forecast->shortfall ? "short" : "ok"));
+    canvas_draw_str(canvas, 5, 22 + period_count * 8, info);
+}
+
+static void attack_view_draw_jitter(Canvas* canvas, OpenSesameApp* app) {
+    char info[32];
+    const JitterHistogram* jitter = &app->jitter;
+
+    // Chunk on-air error histogram, two columns
+    for(uint8_t b = 0; b < JITTER_BUCKET_COUNT; b++) {
+        snprintf(info, sizeof(info), "%s:%lu", jitter_bucket_names[b], jitter->buckets[b]);
+        canvas_draw_str(canvas, (b < 4) ? 5 : 68, 22 + (b % 4) * 8, info);
+    }
+    snprintf(info, sizeof(info), "max %luus", jitter->worst_us);
+    canvas_draw_str(canvas, 68, 46, info);
+}
+
+// Airtime against the estimate and overhead, once a step has finished
+static void attack_view_draw_report(Canvas* canvas, OpenSesameApp* app) {
+    char info[32];
+    const RunReport* report = &app->report;
+    if(report->steps == NULL || report->count == 0 || report->airtime_ms == 0) return;
+
+    snprintf(info, sizeof(info), "Est %lu%% Ovh %lu%% Flag %u",
+        (report->estimate_airtime_ms > 0) ?
+            (uint32_t)(report->airtime_ms * 100 / report->estimate_airtime_ms) : 0,
+        (uint32_t)(report->overhead_ms * 100 / report->airtime_ms),
+        report->flagged);
+    canvas_draw_str(canvas, 5, 55, info);
+}
+
 static void attack_view_draw_callback(Canvas* canvas, void* model) {
     if(canvas == NULL || model == NULL) return;
     
     OpenSesameApp* app = *((OpenSesameApp**)model);
+    OPENSESAME_SPAN_BEGIN(app, TraceSpanRedraw, TraceTrackGui, app->attack_page);
     
     canvas_clear(canvas);
     canvas_set_font(canvas, FontPrimary);
@@ -1403,20 +5911,23 @@ static void attack_view_draw_callback(Canvas* canvas, void* model) {
     char info[64];
     bool is_meta_mode = (app->current_target_index == 4 || app->current_target_index == 5 || app->current_target_index == 6);
 
-    if(app->attack_mode == AttackModeDeBruijn || is_meta_mode) {
+    if(app->attack_page == AttackPageTelemetry) {
+        attack_view_draw_telemetry(canvas, app);
+        attack_view_draw_report(canvas, app);
+    } else if(app->attack_page == AttackPageJitter) {
+        attack_view_draw_jitter(canvas, app);
+    } else if(app->attack_mode == AttackModeDeBruijn || is_meta_mode) {
         // De Bruijn mode OR any meta-mode (All Known, Generic, European)
         snprintf(info, sizeof(info), "Codes: %lu / %lu", app->codes_transmitted, app->max_code);
         canvas_draw_str_aligned(canvas, 64, 20, AlignCenter, AlignTop, info);
         
-        CodeBuffer* buffer = &app->code_buffer;
-        if(buffer->count > 0) {
-            uint32_t idx1 = (buffer->head + buffer->count - 1) % CODE_BUFFER_SIZE;
-            snprintf(info, sizeof(info), "Last: 0x%lX", buffer->codes[idx1]);
+        uint32_t code;
+        if(code_buffer_sent(&app->code_buffer, 0, &code)) {
+            snprintf(info, sizeof(info), "Last: 0x%lX", code);
             canvas_draw_str(canvas, 5, 35, info);
         }
-        if(buffer->count > 1) {
-            uint32_t idx2 = (buffer->head + buffer->count - 2) % CODE_BUFFER_SIZE;
-            snprintf(info, sizeof(info), "Prev: 0x%lX", buffer->codes[idx2]);
+        if(code_buffer_sent(&app->code_buffer, 1, &code)) {
+            snprintf(info, sizeof(info), "Prev: 0x%lX", code);
             canvas_draw_str(canvas, 5, 45, info);
         }
     } else {
@@ -1424,19 +5935,35 @@ static void attack_view_draw_callback(Canvas* canvas, void* model) {
         snprintf(info, sizeof(info), "Progress: %lu / %lu", app->current_code, app->max_code);
         canvas_draw_str_aligned(canvas, 64, 20, AlignCenter, AlignTop, info);
         
-        CodeBuffer* buffer = &app->code_buffer;
-        if(buffer->count > 0) {
-            uint32_t idx1 = (buffer->head + buffer->count - 1) % CODE_BUFFER_SIZE;
-            snprintf(info, sizeof(info), "Last: 0x%lX", buffer->codes[idx1]);
+        uint32_t code;
+        if(code_buffer_sent(&app->code_buffer, 0, &code)) {
+            snprintf(info, sizeof(info), "Last: 0x%lX", code);
             canvas_draw_str(canvas, 5, 35, info);
         }
-        if(buffer->count > 1) {
-            uint32_t idx2 = (buffer->head + buffer->count - 2) % CODE_BUFFER_SIZE;
-            snprintf(info, sizeof(info), "Prev: 0x%lX", buffer->codes[idx2]);
+        if(code_buffer_sent(&app->code_buffer, 1, &code)) {
+            snprintf(info, sizeof(info), "Prev: 0x%lX", code);
             canvas_draw_str(canvas, 5, 45, info);
         }
     }
     
+    if(app->attack_page == AttackPageProgress && app->paused) {
+        canvas_draw_str(canvas, 5, 55, "Paused (CLI)");
+    } else if(app->attack_page == AttackPageProgress && app->duty_waiting) {
+        canvas_draw_str(canvas, 5, 55, "Duty-cycle wait...");
+    } else if(app->attack_page == AttackPageProgress && app->history.hit_marked) {
+        snprintf(info, sizeof(info), "Hit saved: 0x%lX", app->history.hit_code);
+        canvas_draw_str(canvas, 5, 55, info);
+    } else if(app->attack_page == AttackPageProgress && app->tune_run) {
+        canvas_draw_str(canvas, 5, 55, app->is_attacking ? "Tuning..." : app->tune_summary);
+    } else if(app->attack_page == AttackPageProgress && app->queue_run) {
+        if(app->is_attacking) {
+            snprintf(info, sizeof(info), "Job %u/%u", app->job_index + 1, app->job_count);
+            canvas_draw_str(canvas, 5, 55, info);
+        } else if(app->queue_summary[0] != '\0') {
+            canvas_draw_str(canvas, 5, 55, app->queue_summary);
+        }
+    }
+
     if(app->is_attacking) {
         canvas_set_font(canvas, FontSecondary);
         canvas_draw_str(canvas, 5, 63, "[OK] Rstrt [BACK] Stop");
@@ -1444,6 +5971,7 @@ static void attack_view_draw_callback(Canvas* canvas, void* model) {
         canvas_set_font(canvas, FontSecondary);
         canvas_draw_str(canvas, 5, 63, "[OK] Retry [BACK] Exit");
     }
+    OPENSESAME_SPAN_END(app, TraceSpanRedraw, TraceTrackGui);
 }
 
 static bool attack_view_input_callback(InputEvent* event, void* context) {
@@ -1455,75 +5983,43 @@ static bool attack_view_input_callback(InputEvent* event, void* context) {
         if(event->key == InputKeyBack) {
             if(app->is_attacking && app->worker_thread != NULL) {
                 FURI_LOG_I("OpenSesame", "Stopping attack via BACK");
-                
-                FuriThreadId thread_id = furi_thread_get_id(app->worker_thread);
-                if(thread_id != NULL) {
-                    furi_thread_flags_set(thread_id, WORKER_EVENT_STOP);
-                }
-                furi_delay_ms(100);
-            }
-            
-            if(app->worker_thread != NULL) {
-                furi_thread_join(app->worker_thread);
-                furi_thread_free(app->worker_thread);
-                app->worker_thread = NULL;
             }
+            opensesame_stop_worker(app);
             
-            app->is_attacking = false;
-            
-            view_dispatcher_switch_to_view(app->view_dispatcher, ViewIdMenu);
+            opensesame_switch_to_view(app, ViewIdMenu);
             return true;
         } 
+        else if(event->key == InputKeyUp || event->key == InputKeyDown) {
+            app->attack_page = (app->attack_page + 1) % AttackPageCount;
+            return true;
+        }
+        else if(event->key == InputKeyOk && event->type == InputTypeLong && app->is_attacking) {
+            // Receiver opened: keep the code just sent as a hit for its target
+            uint32_t code;
+            uint8_t target;
+            if(history_mark_hit(app, &code, &target)) {
+                FURI_LOG_I("OpenSesame", "Hit marked: 0x%lX for target %u", code, target);
+            }
+            return true;
+        }
         else if(event->key == InputKeyOk) {
             if(app->is_attacking) {
                 // --- RESTART LOGIC ---
                 FURI_LOG_I("OpenSesame", "Restarting attack via OK");
 
-                // 1. Stop current worker
-                if(app->worker_thread != NULL) {
-                    FuriThreadId thread_id = furi_thread_get_id(app->worker_thread);
-                    if(thread_id != NULL) {
-                        furi_thread_flags_set(thread_id, WORKER_EVENT_STOP);
-                    }
-                    furi_delay_ms(100); // Wait for flag to be processed
-                    
-                    // 2. Join/free current worker
-                    furi_thread_join(app->worker_thread);
-                    furi_thread_free(app->worker_thread);
-                    app->worker_thread = NULL;
-                }
+                // 1. Stop and join current worker
+                opensesame_stop_worker(app);
                 
-                // 3. Start new worker (same as opensesame_submenu_callback)
-                app->is_attacking = true;
-                app->current_code = 0;
-                app->codes_transmitted = 0;
-                app->attack_animation_index = 0;
-                app->worker_thread = furi_thread_alloc_ex(
-                    "OpenSesameWorker", 8192, opensesame_worker_thread, app);
-                if(app->worker_thread != NULL) {
-                    furi_thread_start(app->worker_thread);
-                } else {
-                    FURI_LOG_E("OpenSesame", "Failed to allocate worker thread");
-                    app->is_attacking = false;
-                }
+                // 2. Start new worker (a running queue starts over)
+                opensesame_start_worker(app);
                 
             } else { // !app->is_attacking
                 // --- RETRY LOGIC ---
                 FURI_LOG_I("OpenSesame", "Retrying attack via OK");
 
-                // Start new worker (same as opensesame_submenu_callback)
-                app->is_attacking = true;
-                app->current_code = 0;
-                app->codes_transmitted = 0;
-                app->attack_animation_index = 0;
-                app->worker_thread = furi_thread_alloc_ex(
-                    "OpenSesameWorker", 8192, opensesame_worker_thread, app);
-                if(app->worker_thread != NULL) {
-                    furi_thread_start(app->worker_thread);
-                } else {
-                    FURI_LOG_E("OpenSesame", "Failed to allocate worker thread");
-                    app->is_attacking = false;
-                }
+                // Join the finished worker, then start a new one (a finished queue runs again)
+                opensesame_stop_worker(app);
+                opensesame_start_worker(app);
             }
             return true;
         }
@@ -1561,7 +6057,6 @@ static void attack_view_exit_callback(void* context) {
             if(thread_id != NULL) {
                 furi_thread_flags_set(thread_id, WORKER_EVENT_STOP);
             }
-            furi_delay_ms(200);
         }
         
         furi_thread_join(app->worker_thread);
@@ -1572,6 +6067,197 @@ static void attack_view_exit_callback(void* context) {
     app->is_attacking = false;
 }
 
+// --- Settings View ---
+static const char* const settings_off_on_names[] = {"Off", "On"};
+
+static void settings_drift_sweep_changed(VariableItem* item) {
+    OpenSesameApp* app = variable_item_get_context(item);
+    uint8_t index = variable_item_get_current_value_index(item);
+
+    app->drift_sweep = (index == 1);
+    variable_item_set_current_value_text(item, settings_off_on_names[index]);
+}
+
+static void settings_rate_sweep_changed(VariableItem* item) {
+    OpenSesameApp* app = variable_item_get_context(item);
+    uint8_t index = variable_item_get_current_value_index(item);
+
+    app->rate_sweep = (index == 1);
+    variable_item_set_current_value_text(item, settings_off_on_names[index]);
+}
+
+static void settings_tx_priority_changed(VariableItem* item) {
+    OpenSesameApp* app = variable_item_get_context(item);
+    uint8_t index = variable_item_get_current_value_index(item);
+
+    app->tx_priority = index;
+    variable_item_set_current_value_text(item, tx_priority_names[index]);
+}
+
+static void settings_radio_setup_changed(VariableItem* item) {
+    OpenSesameApp* app = variable_item_get_context(item);
+    uint8_t index = variable_item_get_current_value_index(item);
+
+    app->radio_setup = (RadioSetup)index;
+    variable_item_set_current_value_text(item, radio_setup_names[index]);
+}
+
+static void settings_long_run_changed(VariableItem* item) {
+    OpenSesameApp* app = variable_item_get_context(item);
+    uint8_t index = variable_item_get_current_value_index(item);
+
+    app->long_run = (index == 1);
+    variable_item_set_current_value_text(item, settings_off_on_names[index]);
+}
+
+static void settings_dry_run_changed(VariableItem* item) {
+    OpenSesameApp* app = variable_item_get_context(item);
+    uint8_t index = variable_item_get_current_value_index(item);
+
+    app->dry_run = (index == 1);
+    variable_item_set_current_value_text(item, settings_off_on_names[index]);
+}
+
+static void settings_trace_changed(VariableItem* item) {
+    OpenSesameApp* app = variable_item_get_context(item);
+    uint8_t index = variable_item_get_current_value_index(item);
+
+    app->event_log.trace_wanted = (index == 1);
+    variable_item_set_current_value_text(item, settings_off_on_names[index]);
+}
+
+static void settings_list_setup(OpenSesameApp* app) {
+    variable_item_list_reset(app->settings_list);
+
+    VariableItem* item = variable_item_list_add(
+        app->settings_list, "Drift Sweep", COUNT_OF(settings_off_on_names),
+        settings_drift_sweep_changed, app);
+    variable_item_set_current_value_index(item, app->drift_sweep);
+    variable_item_set_current_value_text(item, settings_off_on_names[app->drift_sweep]);
+
+    item = variable_item_list_add(
+        app->settings_list, "Rate Sweep", COUNT_OF(settings_off_on_names),
+        settings_rate_sweep_changed, app);
+    variable_item_set_current_value_index(item, app->rate_sweep);
+    variable_item_set_current_value_text(item, settings_off_on_names[app->rate_sweep]);
+
+    item = variable_item_list_add(
+        app->settings_list, "TX Priority", COUNT_OF(tx_priority_names),
+        settings_tx_priority_changed, app);
+    variable_item_set_current_value_index(item, app->tx_priority);
+    variable_item_set_current_value_text(item, tx_priority_names[app->tx_priority]);
+
+    item = variable_item_list_add(
+        app->settings_list, "Radios", RadioSetupCount, settings_radio_setup_changed, app);
+    variable_item_set_current_value_index(item, app->radio_setup);
+    variable_item_set_current_value_text(item, radio_setup_names[app->radio_setup]);
+
+    item = variable_item_list_add(
+        app->settings_list, "Dry Run", COUNT_OF(settings_off_on_names),
+        settings_dry_run_changed, app);
+    variable_item_set_current_value_index(item, app->dry_run);
+    variable_item_set_current_value_text(item, settings_off_on_names[app->dry_run]);
+
+    item = variable_item_list_add(
+        app->settings_list, "Long Run", COUNT_OF(settings_off_on_names),
+        settings_long_run_changed, app);
+    variable_item_set_current_value_index(item, app->long_run);
+    variable_item_set_current_value_text(item, settings_off_on_names[app->long_run]);
+
+    uint8_t trace = app->event_log.trace_wanted;
+    item = variable_item_list_add(
+        app->settings_list, "Trace", COUNT_OF(settings_off_on_names), settings_trace_changed, app);
+    variable_item_set_current_value_index(item, trace);
+    variable_item_set_current_value_text(item, settings_off_on_names[trace]);
+}
+
+// --- Job Queue View ---
+static const char* const queue_mode_short_names[] = {"Compat", "Stream", "dB"};
+
+static void queue_menu_callback(void* context, uint32_t index) {
+    OpenSesameApp* app = (OpenSesameApp*)context;
+    app->queue_selected = index;
+
+    switch(index) {
+    case QueueIndexAdd:
+        if(app->job_count < JOB_QUEUE_MAX) {
+            opensesame_job_capture(app, &app->jobs[app->job_count++]);
+            snprintf(app->queue_status, sizeof(app->queue_status), "Added job %u", app->job_count);
+        } else {
+            snprintf(app->queue_status, sizeof(app->queue_status), "Queue full");
+        }
+        break;
+    case QueueIndexRun:
+        if(app->job_count == 0) {
+            snprintf(app->queue_status, sizeof(app->queue_status), "Queue empty");
+            break;
+        }
+        app->queue_run = true;
+        app->tune_run = false;
+        app->stop_bench = false;
+        app->job_index = 0;
+        if(opensesame_start_worker(app)) {
+            opensesame_switch_to_view(app, ViewIdAttack);
+        }
+        return;
+    case QueueIndexSave:
+        if(job_queue_save(app)) {
+            snprintf(app->queue_status, sizeof(app->queue_status), "Saved %u jobs", app->job_count);
+        } else {
+            snprintf(app->queue_status, sizeof(app->queue_status), "Save failed");
+        }
+        break;
+    case QueueIndexLoad:
+        if(job_queue_load(app)) {
+            snprintf(app->queue_status, sizeof(app->queue_status), "Loaded %u jobs", app->job_count);
+        } else {
+            snprintf(app->queue_status, sizeof(app->queue_status), "Load failed");
+        }
+        break;
+    case QueueIndexClear:
+        app->job_count = 0;
+        snprintf(app->queue_status, sizeof(app->queue_status), "Queue cleared");
+        break;
+    default: {
+        // OK on a job removes it
+        uint8_t job = index - QueueIndexJobBase;
+        if(job >= app->job_count) return;
+        memmove(&app->jobs[job], &app->jobs[job + 1],
+            sizeof(OpenSesameJob) * (app->job_count - job - 1));
+        app->job_count--;
+        snprintf(app->queue_status, sizeof(app->queue_status), "Removed job %u", job + 1);
+        break;
+    }
+    }
+
+    // Rebuild from the event loop, not from inside the submenu's own callback
+    view_dispatcher_send_custom_event(app->view_dispatcher, OpenSesameEventQueueChanged);
+}
+
+static void queue_menu_setup(OpenSesameApp* app) {
+    submenu_reset(app->queue_menu);
+    submenu_set_header(app->queue_menu, app->queue_status);
+
+    char label[48];
+    snprintf(label, sizeof(label), "Add Current (%u/%u)", app->job_count, JOB_QUEUE_MAX);
+    submenu_add_item(app->queue_menu, label, QueueIndexAdd, queue_menu_callback, app);
+    submenu_add_item(app->queue_menu, "Run Queue", QueueIndexRun, queue_menu_callback, app);
+    submenu_add_item(app->queue_menu, "Save to SD", QueueIndexSave, queue_menu_callback, app);
+    submenu_add_item(app->queue_menu, "Load from SD", QueueIndexLoad, queue_menu_callback, app);
+    submenu_add_item(app->queue_menu, "Clear Queue", QueueIndexClear, queue_menu_callback, app);
+
+    for(uint8_t i = 0; i < app->job_count; i++) {
+        const OpenSesameJob* job = &app->jobs[i];
+        snprintf(label, sizeof(label), "%u. %s %s%s%s",
+            i + 1,
+            opensesame_targets[job->target_index].name,
+            queue_mode_short_names[job->attack_mode],
+            (job->options & JobOptionDriftSweep) ? " +D" : "",
+            (job->options & JobOptionRateSweep) ? " +R" : "");
+        submenu_add_item(app->queue_menu, label, QueueIndexJobBase + i, queue_menu_callback, app);
+    }
+}
+
 // --- Config View ---
 static void config_widget_setup(OpenSesameApp* app);
 // static void directions_widget_setup(OpenSesameApp* app);
@@ -1581,7 +6267,7 @@ static bool config_input_callback(InputEvent* event, void* context) {
     if(event == NULL || event->type != InputTypeShort) return false;
 
     if(event->key == InputKeyOk || event->key == InputKeyBack) {
-        view_dispatcher_switch_to_view(app->view_dispatcher, ViewIdMenu);
+        opensesame_switch_to_view(app, ViewIdMenu);
         return true;
     }
     return false;
@@ -1612,14 +6298,48 @@ static void config_widget_setup(OpenSesameApp* app) {
 
     const OpenSesameTarget* target = &opensesame_targets[app->current_target_index];
 
+    history_ensure_loaded(&app->history);
+    AttackPlan plan;
+    opensesame_plan_build(app, &plan);
+    char airtime[16];
+    opensesame_format_duration(
+        airtime, sizeof(airtime), opensesame_estimate_plan_airtime_us(app, &plan));
+
+    // Steps run and hits recorded for the plan's targets in this mode
+    uint32_t runs = 0, hits = 0;
+    for(uint8_t i = 0; i < plan.count; i++) {
+        HistoryAggregate aggregate;
+        if(history_lookup(&app->history, plan.target_idx[i], app->attack_mode, &aggregate)) {
+            runs += aggregate.runs;
+            hits += aggregate.hit_count;
+        }
+    }
+
+    char tuning[32];
+    if(app->tuning.tick_us == 0) {
+        snprintf(tuning, sizeof(tuning), "defaults");
+    } else {
+        snprintf(tuning, sizeof(tuning), "%lums chunks, %lums gaps",
+            app->tuning.chunk_airtime_ms, app->tuning.variant_gap_ms);
+    }
+
     char config_text[256];
     snprintf(config_text, sizeof(config_text),
         "Current Config\n\n"
         "Target:\n%s\n\n"
         "Mode:\n%s\n\n"
+        "Airtime: %s%s%s\n"
+        "History: %lu runs, %lu hits\n"
+        "Tuning: %s\n\n"
         "[OK] Return",
         target->name,
-        attack_mode_names[app->attack_mode]);
+        attack_mode_names[app->attack_mode],
+        airtime,
+        app->drift_sweep ? " +drift" : "",
+        app->rate_sweep ? " +rate" : "",
+        runs,
+        hits,
+        tuning);
 
     widget_add_text_box_element(
         app->config_widget,
@@ -1701,10 +6421,185 @@ static void about_widget_setup(OpenSesameApp* app) {
     //    false);
 //}
 
+// --- Lazy Views ---
+static void opensesame_view_acquire(OpenSesameApp* app, OpenSesameViewId view_id) {
+    switch(view_id) {
+    case ViewIdAttackMode:
+        if(app->attack_mode_widget != NULL) return;
+        app->attack_mode_widget = widget_alloc();
+        view_set_context(widget_get_view(app->attack_mode_widget), app);
+        view_set_input_callback(widget_get_view(app->attack_mode_widget), attack_mode_input_callback);
+        view_dispatcher_add_view(app->view_dispatcher, ViewIdAttackMode, 
+            widget_get_view(app->attack_mode_widget));
+        break;
+    case ViewIdTargetSelect:
+        if(app->target_widget != NULL) return;
+        app->target_widget = widget_alloc();
+        view_set_context(widget_get_view(app->target_widget), app);
+        view_set_input_callback(widget_get_view(app->target_widget), target_input_callback);
+        view_dispatcher_add_view(app->view_dispatcher, ViewIdTargetSelect, 
+            widget_get_view(app->target_widget));
+        break;
+    case ViewIdConfig:
+        if(app->config_widget != NULL) return;
+        app->config_widget = widget_alloc();
+        view_set_context(widget_get_view(app->config_widget), app);
+        view_set_input_callback(widget_get_view(app->config_widget), config_input_callback);
+        view_dispatcher_add_view(app->view_dispatcher, ViewIdConfig, 
+            widget_get_view(app->config_widget));
+        break;
+    case ViewIdAbout:
+        if(app->about_widget != NULL) return;
+        app->about_widget = widget_alloc();
+        view_set_context(widget_get_view(app->about_widget), app);
+        view_set_input_callback(widget_get_view(app->about_widget), about_input_callback);
+        view_dispatcher_add_view(app->view_dispatcher, ViewIdAbout, 
+            widget_get_view(app->about_widget));
+        break;
+    case ViewIdSettings:
+        if(app->settings_list != NULL) return;
+        app->settings_list = variable_item_list_alloc();
+        view_dispatcher_add_view(app->view_dispatcher, ViewIdSettings, 
+            variable_item_list_get_view(app->settings_list));
+        break;
+    case ViewIdQueue:
+        if(app->queue_menu != NULL) return;
+        app->queue_menu = submenu_alloc();
+        view_dispatcher_add_view(app->view_dispatcher, ViewIdQueue, 
+            submenu_get_view(app->queue_menu));
+        break;
+    case ViewIdAttack: {
+        if(app->attack_view != NULL) return;
+        app->attack_view = view_alloc();
+        view_allocate_model(app->attack_view, ViewModelTypeLockFree, sizeof(OpenSesameApp*));
+        OpenSesameApp** attack_model = view_get_model(app->attack_view);
+        *attack_model = app;
+        view_set_context(app->attack_view, app);
+        view_set_draw_callback(app->attack_view, attack_view_draw_callback);
+        view_set_input_callback(app->attack_view, attack_view_input_callback);
+        view_set_enter_callback(app->attack_view, attack_view_enter_callback);
+        view_set_exit_callback(app->attack_view, attack_view_exit_callback);
+        view_set_previous_callback(app->attack_view, NULL);
+        view_dispatcher_add_view(app->view_dispatcher, ViewIdAttack, app->attack_view);
+        break;
+    }
+    default:
+        break;
+    }
+}
+
+static void opensesame_view_release(OpenSesameApp* app, OpenSesameViewId view_id) {
+    switch(view_id) {
+    case ViewIdAttackMode:
+        if(app->attack_mode_widget == NULL) return;
+        view_dispatcher_remove_view(app->view_dispatcher, ViewIdAttackMode);
+        widget_free(app->attack_mode_widget);
+        app->attack_mode_widget = NULL;
+        break;
+    case ViewIdTargetSelect:
+        if(app->target_widget == NULL) return;
+        view_dispatcher_remove_view(app->view_dispatcher, ViewIdTargetSelect);
+        widget_free(app->target_widget);
+        app->target_widget = NULL;
+        break;
+    case ViewIdConfig:
+        if(app->config_widget == NULL) return;
+        view_dispatcher_remove_view(app->view_dispatcher, ViewIdConfig);
+        widget_free(app->config_widget);
+        app->config_widget = NULL;
+        break;
+    case ViewIdAbout:
+        if(app->about_widget == NULL) return;
+        view_dispatcher_remove_view(app->view_dispatcher, ViewIdAbout);
+        widget_free(app->about_widget);
+        app->about_widget = NULL;
+        break;
+    case ViewIdSettings:
+        if(app->settings_list == NULL) return;
+        view_dispatcher_remove_view(app->view_dispatcher, ViewIdSettings);
+        variable_item_list_free(app->settings_list);
+        app->settings_list = NULL;
+        break;
+    case ViewIdQueue:
+        if(app->queue_menu == NULL) return;
+        view_dispatcher_remove_view(app->view_dispatcher, ViewIdQueue);
+        submenu_free(app->queue_menu);
+        app->queue_menu = NULL;
+        break;
+    case ViewIdAttack:
+        if(app->attack_view == NULL) return;
+        view_dispatcher_remove_view(app->view_dispatcher, ViewIdAttack);
+        view_free(app->attack_view);
+        app->attack_view = NULL;
+        break;
+    default:
+        break;
+    }
+}
+
+static void opensesame_switch_to_view(OpenSesameApp* app, OpenSesameViewId view_id) {
+    opensesame_view_acquire(app, view_id);
+    view_dispatcher_switch_to_view(app->view_dispatcher, view_id);
+    app->current_view = view_id;
+
+    // Views are freed from the event loop, never inside their own callbacks
+    if(view_id == ViewIdMenu) {
+        view_dispatcher_send_custom_event(app->view_dispatcher, OpenSesameEventReleaseViews);
+    }
+}
+
 // --- View Dispatcher Callbacks ---
-static uint32_t opensesame_back_callback(void* context) {
-    UNUSED(context);
-    return ViewIdMenu;
+static bool opensesame_custom_event_callback(void* context, uint32_t event) {
+    OpenSesameApp* app = (OpenSesameApp*)context;
+
+    if(event == OpenSesameEventReleaseViews) {
+        for(size_t i = 0; i < COUNT_OF(opensesame_lazy_views); i++) {
+            if(opensesame_lazy_views[i] != app->current_view) {
+                opensesame_view_release(app, opensesame_lazy_views[i]);
+            }
+        }
+        FURI_LOG_D("OpenSesame", "Views released, free heap %u bytes", memmgr_get_free_heap());
+        return true;
+    }
+    if(event == OpenSesameEventCliStart) {
+        opensesame_stop_worker(app); // Join a worker that already finished
+        app->queue_run = app->cli_start_queue;
+        app->tune_run = app->cli_start_tune;
+        app->stop_bench = app->cli_start_bench;
+        app->job_index = 0;
+        if(opensesame_start_worker(app)) {
+            opensesame_switch_to_view(app, ViewIdAttack);
+        }
+        return true;
+    }
+    if(event == OpenSesameEventCliStop) {
+        opensesame_stop_worker(app);
+        return true;
+    }
+    if(event == OpenSesameEventTunePing) {
+        const uint32_t ping_us = app->tune_ping_us;
+        if(ping_us != 0) {
+            app->tune_latency_us = MAX((uint32_t)clock_now_us(&app->device_clock) - ping_us, 1UL);
+        }
+        return true;
+    }
+    if(event == OpenSesameEventQueueChanged) {
+        if(app->queue_menu != NULL) {
+            queue_menu_setup(app);
+            submenu_set_selected_item(app->queue_menu, app->queue_selected);
+        }
+        return true;
+    }
+    return false;
+}
+
+// Lazy views have no previous callback, so BACK lands here
+static bool opensesame_navigation_event_callback(void* context) {
+    OpenSesameApp* app = (OpenSesameApp*)context;
+
+    if(app->current_view == ViewIdMenu) return false; // Exit the app
+    opensesame_switch_to_view(app, ViewIdMenu);
+    return true;
 }
 
 static uint32_t opensesame_exit_callback(void* context) {
@@ -1718,40 +6613,56 @@ static void opensesame_submenu_callback(void* context, uint32_t index) {
 
     switch(index) {
     case SubmenuIndexStartAttack:
-        app->is_attacking = true;
-        app->current_code = 0;
-        app->codes_transmitted = 0;
-        app->attack_animation_index = 0;
-        app->worker_thread = furi_thread_alloc_ex(
-            "OpenSesameWorker", 8192, opensesame_worker_thread, app);
-        if(app->worker_thread != NULL) {
-            furi_thread_start(app->worker_thread);
-            view_dispatcher_switch_to_view(app->view_dispatcher, ViewIdAttack);
-        } else {
-            FURI_LOG_E("OpenSesame", "Failed to allocate worker thread");
-            app->is_attacking = false;
+        app->queue_run = false;
+        app->tune_run = false;
+        app->stop_bench = false;
+        if(opensesame_start_worker(app)) {
+            opensesame_switch_to_view(app, ViewIdAttack);
         }
         break;
     case SubmenuIndexAttackMode:
+        opensesame_view_acquire(app, ViewIdAttackMode);
         attack_mode_widget_setup(app);
-        view_dispatcher_switch_to_view(app->view_dispatcher, ViewIdAttackMode);
+        opensesame_switch_to_view(app, ViewIdAttackMode);
         break;
     case SubmenuIndexTargetSelect:
+        opensesame_view_acquire(app, ViewIdTargetSelect);
         target_widget_setup(app);
-        view_dispatcher_switch_to_view(app->view_dispatcher, ViewIdTargetSelect);
+        opensesame_switch_to_view(app, ViewIdTargetSelect);
         break;
     case SubmenuIndexShowConfig:
+        opensesame_view_acquire(app, ViewIdConfig);
         config_widget_setup(app);
-        view_dispatcher_switch_to_view(app->view_dispatcher, ViewIdConfig);
+        opensesame_switch_to_view(app, ViewIdConfig);
+        break;
+    case SubmenuIndexSettings:
+        opensesame_view_acquire(app, ViewIdSettings);
+        settings_list_setup(app);
+        opensesame_switch_to_view(app, ViewIdSettings);
+        break;
+    case SubmenuIndexJobQueue:
+        opensesame_view_acquire(app, ViewIdQueue);
+        snprintf(app->queue_status, sizeof(app->queue_status), "Job Queue");
+        queue_menu_setup(app);
+        opensesame_switch_to_view(app, ViewIdQueue);
         break;
     //case SubmenuIndexDirections:
     //    directions_widget_setup(app);
     //    view_dispatcher_switch_to_view(app->view_dispatcher, ViewIdDirections);
     //    break;
+    case SubmenuIndexAutoTune:
+        app->queue_run = false;
+        app->tune_run = true;
+        app->stop_bench = false;
+        if(opensesame_start_worker(app)) {
+            opensesame_switch_to_view(app, ViewIdAttack);
+        }
+        break;
     case SubmenuIndexAbout:
         app->about_page = 0;
+        opensesame_view_acquire(app, ViewIdAbout);
         about_widget_setup(app);
-        view_dispatcher_switch_to_view(app->view_dispatcher, ViewIdAbout);
+        opensesame_switch_to_view(app, ViewIdAbout);
         break;
     case SubmenuIndexExit:
         view_dispatcher_stop(app->view_dispatcher);
@@ -1761,6 +6672,377 @@ static void opensesame_submenu_callback(void* context, uint32_t index) {
     }
 }
 
+// --- CLI ---
+// One line per record, "<kind> key=value ...", so scripts can parse progress
+static void opensesame_cli_print_status(OpenSesameApp* app, const char* kind) {
+    uint64_t airtime_us = 0;
+    for(uint8_t r = 0; r < BIT_PERIOD_VARIANTS_MAX; r++) {
+        airtime_us += app->variant_airtime_us[r];
+    }
+    const char* state = !app->is_attacking ? "idle" :
+                        app->paused        ? "paused" :
+                        app->duty_waiting  ? "duty_wait" :
+                                             "running";
+
+    printf("%s t=%lu state=%s target=%u mode=%u job=%u/%u radios=%u codes=%lu max=%lu "
+           "airtime_ms=%lu chunks=%lu worst_us=%lu packs=%u pack_damaged=%u",
+        kind,
+        furi_get_tick(),
+        state,
+        app->current_attack_target_idx,
+        app->attack_mode,
+        app->queue_run ? app->job_index + 1 : 0,
+        app->queue_run ? app->job_count : 0,
+        app->radio_count,
+        app->codes_transmitted,
+        app->max_code,
+        (uint32_t)(airtime_us / 1000),
+        app->jitter.chunks,
+        app->jitter.worst_us,
+        app->sequence_cache.pack_loads,
+        app->sequence_cache.pack_damaged);
+    if(app->attack_mode == AttackModeDeBruijn) {
+        printf(" strategy=%s", sequence_strategy_names[app->sequence_strategy]);
+    }
+    if(app->clock == &app->virtual_clock) {
+        printf(" dry=1 sim_ms=%lu", clock_now_ms(app->clock));
+    }
+    if(app->long_run) {
+        printf(" battery_ma=%lu need_mah=%lu usable_mah=%lu trimmed=%u",
+            app->forecast.average_ma,
+            app->forecast.needed_mah,
+            app->forecast.usable_mah,
+            app->forecast.trimmed);
+    }
+    printf("\r\n");
+}
+
+static void opensesame_cli_print_codes(OpenSesameApp* app, int requested) {
+    const CodeBuffer* buffer = &app->code_buffer;
+    const uint32_t limit = (requested > 0) ? (uint32_t)requested : CODE_BUFFER_SIZE;
+    uint32_t count = 0;
+    uint32_t code;
+    while(count < limit && code_buffer_sent(buffer, count, &code)) count++;
+
+    // Oldest first, ending with the most recent code sent
+    for(uint32_t i = count; i > 0; i--) {
+        if(code_buffer_sent(buffer, i - 1, &code)) printf("code 0x%lX\r\n", code);
+    }
+    printf("ok codes=%lu\r\n", count);
+}
+
+// Waits for the GUI thread to act on a custom event
+static bool opensesame_cli_wait_attacking(OpenSesameApp* app, bool attacking, uint32_t timeout_ms) {
+    for(uint32_t waited = 0; app->is_attacking != attacking; waited += 10) {
+        if(waited >= timeout_ms) return false;
+        furi_delay_ms(10);
+    }
+    return true;
+}
+
+// Stop latency on simulated radios in real time, for every mode and worker
+// phase: each trial starts the selection, waits for the phase, requests the
+// stop and times it until the worker is done. The worker is left at normal
+// priority so this thread can catch it computing as well as waiting.
+static void opensesame_cli_bench_stop(OpenSesameApp* app, Cli* cli, int trials) {
+    uint32_t* samples = malloc(sizeof(uint32_t) * AttackModeCount * WORKER_PHASE_COUNT * trials);
+    if(samples == NULL) {
+        printf("error memory\r\n");
+        return;
+    }
+    uint8_t counts[AttackModeCount][WORKER_PHASE_COUNT];
+    memset(counts, 0, sizeof(counts));
+    OpenSesameJob selection;
+    opensesame_job_capture(app, &selection);
+
+    // Worker track phases; one a mode never reaches is tried only once
+    static const uint8_t phases[] = {
+        WORKER_PHASE_SCHEDULING,
+        TraceSpanGenerate + 1,
+        TraceSpanEncode + 1,
+        TraceSpanRadioSetup + 1,
+        TraceSpanRadioWait + 1,
+        TraceSpanSleep + 1,
+    };
+    bool interrupted = false;
+    uint32_t worst_us = 0;
+    for(uint8_t mode = 0; mode < AttackModeCount && !interrupted; mode++) {
+        for(size_t p = 0; p < COUNT_OF(phases) && !interrupted; p++) {
+            const uint8_t phase = phases[p];
+            bool reached = true;
+            for(int trial = 0; trial < trials && reached; trial++) {
+                if(app->cli_closing || cli_cmd_interrupt_received(cli)) {
+                    interrupted = true;
+                    break;
+                }
+                app->attack_mode = (AttackMode)mode;
+                app->cli_start_queue = false;
+                app->cli_start_tune = false;
+                app->cli_start_bench = true;
+                view_dispatcher_send_custom_event(app->view_dispatcher, OpenSesameEventCliStart);
+                if(!opensesame_cli_wait_attacking(app, true, 1000)) {
+                    interrupted = true;
+                    break;
+                }
+
+                // Later trials stop further into the run
+                FuriThreadId worker = NULL;
+                const uint32_t start_tick = furi_get_tick();
+                while(app->is_attacking && furi_get_tick() - start_tick < STOP_BENCH_PHASE_WAIT_MS &&
+                      (worker == NULL || app->worker_phase != phase ||
+                       furi_get_tick() - start_tick < (uint32_t)trial)) {
+                    if(worker == NULL && app->worker_thread != NULL) {
+                        worker = furi_thread_get_id(app->worker_thread);
+                    }
+                    furi_thread_yield();
+                }
+                if(worker == NULL || !app->is_attacking) continue; // Finished first
+
+                reached = furi_get_tick() - start_tick < STOP_BENCH_PHASE_WAIT_MS;
+                const uint8_t stopped_in = app->worker_phase;
+                const uint64_t stop_us = clock_now_us(&app->device_clock);
+                furi_thread_flags_set(worker, WORKER_EVENT_STOP);
+                while(app->is_attacking) furi_thread_yield();
+                const uint32_t latency_us = clock_now_us(&app->device_clock) - stop_us;
+
+                worst_us = MAX(worst_us, latency_us);
+                if(counts[mode][stopped_in] < trials) {
+                    const uint32_t cell = (mode * WORKER_PHASE_COUNT + stopped_in) * trials;
+                    samples[cell + counts[mode][stopped_in]++] = latency_us;
+                }
+            }
+        }
+    }
+    view_dispatcher_send_custom_event(app->view_dispatcher, OpenSesameEventCliStop);
+    opensesame_cli_wait_attacking(app, false, 2000);
+    app->cli_start_bench = false;
+    opensesame_job_apply(app, &selection);
+
+    // Phases a mode never stopped in are left out
+    for(uint8_t mode = 0; mode < AttackModeCount; mode++) {
+        for(uint8_t phase = 0; phase < WORKER_PHASE_COUNT; phase++) {
+            const uint8_t count = counts[mode][phase];
+            if(count == 0) continue;
+            uint32_t* cell = samples + (mode * WORKER_PHASE_COUNT + phase) * trials;
+            const uint32_t median_us = tuning_median(cell, count);
+            printf("stop mode=%u phase=%s n=%u min_us=%lu median_us=%lu max_us=%lu\r\n",
+                mode, worker_phase_names[phase], count, cell[0], median_us, cell[count - 1]);
+        }
+    }
+    printf("%s stop worst_us=%lu bound_ms=%u\r\n", interrupted ? "error interrupted" : "ok",
+        worst_us, STOP_LATENCY_BOUND_MS);
+    free(samples);
+}
+
+// One line per target and mode with history, seconds rounded down
+static void opensesame_cli_print_history(OpenSesameApp* app) {
+    RunHistory* history = &app->history;
+    history_ensure_loaded(history);
+
+    furi_mutex_acquire(history->mutex, FuriWaitForever);
+    for(uint16_t i = 0; i < history->count; i++) {
+        const HistoryAggregate* entry = &history->entries[i];
+        printf("history target=%u mode=%u runs=%u completed=%u airtime_s=%lu wall_s=%lu "
+               "last_run=%lu hits=%u",
+            entry->target, entry->mode, entry->runs, entry->completed,
+            (uint32_t)(entry->airtime_ms / 1000), (uint32_t)(entry->wall_ms / 1000),
+            entry->last_run, entry->hit_count);
+        for(uint8_t h = 0; h < entry->hit_count; h++) {
+            printf(" 0x%lX", entry->hits[h]);
+        }
+        printf("\r\n");
+    }
+    printf("ok history=%u\r\n", history->count);
+    furi_mutex_release(history->mutex);
+}
+
+// Latest run, or the steps finished so far while one is running
+static void opensesame_cli_print_report(OpenSesameApp* app) {
+    const RunReport* report = &app->report;
+    const uint8_t count = (report->steps != NULL) ? report->count : 0;
+    for(uint8_t i = 0; i < count; i++) {
+        const ReportStep* entry = &report->steps[i];
+        printf("step target=%u est_airtime_ms=%lu airtime_ms=%lu est_wall_ms=%lu wall_ms=%lu "
+               "setup_ms=%lu gap_ms=%lu yield_ms=%lu other_ms=%lu idle_ms=%lu shared_ms=%lu "
+               "overhead_permille=%lu flagged=%u\r\n",
+            entry->target, entry->estimate_airtime_ms, entry->airtime_ms,
+            entry->estimate_wall_ms, entry->wall_ms, entry->setup_ms, entry->gap_ms,
+            entry->yield_ms, run_report_other_ms(entry), entry->idle_ms, entry->shared_ms,
+            (entry->airtime_ms > 0) ? (uint32_t)((uint64_t)entry->overhead_ms * 1000 / entry->airtime_ms) : 0,
+            entry->flagged);
+    }
+    printf("ok report steps=%u flagged=%u threshold_permille=%u\r\n",
+        count, report->flagged, REPORT_OVERHEAD_FLAG_PERMILLE);
+}
+
+static void opensesame_cli_print_tuning(OpenSesameApp* app) {
+    const TxTuning* tuning = &app->tuning;
+    printf("tuning tuned=%u firmware=%s chunk_ms=%lu variant_gap_ms=%lu chunk_gap_ms=%lu "
+           "target_gap_ms=%lu yield_digits=%lu setup_us=%lu callback_ppm=%lu tick_us=%lu "
+           "digit_ns=%lu ui_latency_us=%lu\r\n",
+        tuning->tick_us != 0,
+        tuning_firmware(),
+        tuning->chunk_airtime_ms,
+        tuning->variant_gap_ms,
+        tuning->chunk_gap_ms,
+        tuning->target_gap_ms,
+        tuning->yield_digits,
+        tuning->setup_us,
+        tuning->callback_ppm,
+        tuning->tick_us,
+        tuning->digit_ns,
+        tuning->ui_latency_us);
+}
+
+static void opensesame_cli_usage(void) {
+    printf("Usage: " CLI_COMMAND " <cmd> [args]\r\n"
+           "  start [queue]       Run the selection or the job queue\r\n"
+           "  stop                Stop the run\r\n"
+           "  pause | resume      Hold or continue between chunks\r\n"
+           "  status              Print one status record\r\n"
+           "  watch [ms]          Status records until the run ends or Ctrl+C\r\n"
+           "  codes [n]           Last n codes sent, oldest first\r\n"
+           "  trace [on|off]      Record phase spans to " TRACE_PATH "\r\n"
+           "  dry [on|off]        Simulated radios on virtual time\r\n"
+           "  history             Runs and hits per target and mode\r\n"
+           "  report              Estimated against measured time per step, last run\r\n"
+           "  hit                 Record the code just sent as a hit\r\n"
+           "  tune [run]          Print the tuning, or calibrate this device\r\n"
+           "  bench [trials]      Stop latency per mode and phase, simulated radios\r\n"
+           "  select <target> <mode> [options]\r\n");
+}
+
+static void opensesame_cli_command(Cli* cli, FuriString* args, void* context) {
+    OpenSesameApp* app = (OpenSesameApp*)context;
+    app->cli_busy = true;
+
+    FuriString* cmd = furi_string_alloc();
+    FuriString* word = furi_string_alloc();
+
+    if(!args_read_string_and_trim(args, cmd)) {
+        opensesame_cli_usage();
+    } else if(furi_string_equal_str(cmd, "status")) {
+        opensesame_cli_print_status(app, "status");
+    } else if(furi_string_equal_str(cmd, "start")) {
+        bool queue = args_read_string_and_trim(args, word) && furi_string_equal_str(word, "queue");
+        if(app->is_attacking) {
+            printf("error busy\r\n");
+        } else if(queue && app->job_count == 0) {
+            printf("error queue_empty\r\n");
+        } else {
+            app->cli_start_queue = queue;
+            app->cli_start_tune = false;
+            app->cli_start_bench = false;
+            view_dispatcher_send_custom_event(app->view_dispatcher, OpenSesameEventCliStart);
+            printf(opensesame_cli_wait_attacking(app, true, 1000) ? "ok started\r\n" :
+                                                                   "error start\r\n");
+        }
+    } else if(furi_string_equal_str(cmd, "stop")) {
+        if(app->is_attacking) {
+            view_dispatcher_send_custom_event(app->view_dispatcher, OpenSesameEventCliStop);
+            opensesame_cli_wait_attacking(app, false, 2000);
+        }
+        opensesame_cli_print_status(app, "ok");
+    } else if(furi_string_equal_str(cmd, "pause") || furi_string_equal_str(cmd, "resume")) {
+        if(app->is_attacking) {
+            app->paused = furi_string_equal_str(cmd, "pause");
+            printf("ok %s\r\n", app->paused ? "paused" : "resumed");
+        } else {
+            printf("error idle\r\n");
+        }
+    } else if(furi_string_equal_str(cmd, "watch")) {
+        int interval_ms = 1000;
+        args_read_int_and_trim(args, &interval_ms);
+        if(interval_ms < 100) interval_ms = 100;
+
+        while(app->is_attacking && !app->cli_closing && !cli_cmd_interrupt_received(cli)) {
+            opensesame_cli_print_status(app, "progress");
+            furi_delay_ms(interval_ms);
+        }
+        opensesame_cli_print_status(app, "done");
+    } else if(furi_string_equal_str(cmd, "codes")) {
+        int requested = CLI_CODES_DEFAULT;
+        args_read_int_and_trim(args, &requested);
+        opensesame_cli_print_codes(app, requested);
+    } else if(furi_string_equal_str(cmd, "trace")) {
+        if(args_read_string_and_trim(args, word)) {
+            app->event_log.trace_wanted = furi_string_equal_str(word, "on");
+        }
+        printf("trace %s file=" TRACE_PATH "\r\n", app->event_log.trace_wanted ? "on" : "off");
+    } else if(furi_string_equal_str(cmd, "dry")) {
+        if(app->is_attacking) {
+            printf("error busy\r\n");
+        } else {
+            if(args_read_string_and_trim(args, word)) {
+                app->dry_run = furi_string_equal_str(word, "on");
+            }
+            printf("dry %s\r\n", app->dry_run ? "on" : "off");
+        }
+    } else if(furi_string_equal_str(cmd, "history")) {
+        opensesame_cli_print_history(app);
+    } else if(furi_string_equal_str(cmd, "report")) {
+        opensesame_cli_print_report(app);
+    } else if(furi_string_equal_str(cmd, "hit")) {
+        uint32_t code;
+        uint8_t target;
+        if(history_mark_hit(app, &code, &target)) {
+            printf("ok hit=0x%lX target=%u\r\n", code, target);
+        } else {
+            printf("error idle\r\n");
+        }
+    } else if(furi_string_equal_str(cmd, "tune")) {
+        if(!args_read_string_and_trim(args, word)) {
+            opensesame_cli_print_tuning(app);
+        } else if(!furi_string_equal_str(word, "run")) {
+            opensesame_cli_usage();
+        } else if(app->is_attacking) {
+            printf("error busy\r\n");
+        } else {
+            app->cli_start_queue = false;
+            app->cli_start_tune = true;
+            app->cli_start_bench = false;
+            view_dispatcher_send_custom_event(app->view_dispatcher, OpenSesameEventCliStart);
+            printf(opensesame_cli_wait_attacking(app, true, 1000) ? "ok started\r\n" :
+                                                                   "error start\r\n");
+        }
+    } else if(furi_string_equal_str(cmd, "bench")) {
+        int trials = 4;
+        args_read_int_and_trim(args, &trials);
+        if(app->is_attacking) {
+            printf("error busy\r\n");
+        } else {
+            opensesame_cli_bench_stop(app, cli, CLAMP(trials, STOP_BENCH_TRIALS_MAX, 1));
+        }
+    } else if(furi_string_equal_str(cmd, "select")) {
+        int target = -1, mode = -1, options = 0;
+        bool parsed = args_read_int_and_trim(args, &target) && args_read_int_and_trim(args, &mode);
+        args_read_int_and_trim(args, &options);
+
+        OpenSesameJob job = {
+            .target_index = (uint8_t)target,
+            .attack_mode = (uint8_t)mode,
+            .options = (uint8_t)options,
+        };
+        if(app->is_attacking) {
+            printf("error busy\r\n");
+        } else if(!parsed || target < 0 || target > UINT8_MAX || mode < 0 || mode > UINT8_MAX ||
+                  options < 0 || options > UINT8_MAX ||
+                  !opensesame_job_valid(&job)) {
+            printf("error args\r\n");
+        } else {
+            opensesame_job_apply(app, &job);
+            printf("ok target=%u mode=%u options=%u\r\n", job.target_index, job.attack_mode,
+                job.options);
+        }
+    } else {
+        opensesame_cli_usage();
+    }
+
+    furi_string_free(word);
+    furi_string_free(cmd);
+    app->cli_busy = false;
+}
+
 // --- App Allocation ---
 static OpenSesameApp* opensesame_app_alloc() {
     OpenSesameApp* app = malloc(sizeof(OpenSesameApp));
@@ -1769,6 +7051,7 @@ static OpenSesameApp* opensesame_app_alloc() {
 
     app->current_target_index = 0;
     app->attack_mode = AttackModeDeBruijn;
+    app->tx_priority = 1; // High
     app->is_attacking = false;
     app->worker_thread = NULL;
     app->attack_animation_chars = "|/-\\";
@@ -1776,6 +7059,13 @@ static OpenSesameApp* opensesame_app_alloc() {
     app->about_page = 0;
     app->codes_transmitted = 0;
     app->current_attack_target_idx = 0;
+    clock_init(&app->device_clock, false);
+    app->clock = &app->device_clock;
+    airtime_governor_init(&app->governor, &app->device_clock);
+    app->sequence_cache.mutex = furi_mutex_alloc(FuriMutexTypeNormal);
+    app->history.mutex = furi_mutex_alloc(FuriMutexTypeNormal);
+    tuning_load(&app->tuning);
+    event_log_start(&app->event_log);
 
     app->gui = furi_record_open(RECORD_GUI);
     app->view_dispatcher = view_dispatcher_alloc();
@@ -1793,6 +7083,12 @@ static OpenSesameApp* opensesame_app_alloc() {
         opensesame_submenu_callback, app);
     submenu_add_item(app->submenu, "Show Config", SubmenuIndexShowConfig, 
         opensesame_submenu_callback, app);
+    submenu_add_item(app->submenu, "Settings", SubmenuIndexSettings, 
+        opensesame_submenu_callback, app);
+    submenu_add_item(app->submenu, "Job Queue", SubmenuIndexJobQueue, 
+        opensesame_submenu_callback, app);
+    submenu_add_item(app->submenu, "Auto-Tune", SubmenuIndexAutoTune, 
+        opensesame_submenu_callback, app);
     // submenu_add_item(app->submenu, "Directions", SubmenuIndexDirections, 
     //    opensesame_submenu_callback, app);
     submenu_add_item(app->submenu, "About", SubmenuIndexAbout, 
@@ -1802,59 +7098,17 @@ static OpenSesameApp* opensesame_app_alloc() {
     view_set_previous_callback(submenu_get_view(app->submenu), opensesame_exit_callback);
     view_dispatcher_add_view(app->view_dispatcher, ViewIdMenu, submenu_get_view(app->submenu));
 
-    // Attack Mode Widget
-    app->attack_mode_widget = widget_alloc();
-    view_set_context(widget_get_view(app->attack_mode_widget), app);
-    view_set_previous_callback(widget_get_view(app->attack_mode_widget), opensesame_back_callback);
-    view_set_input_callback(widget_get_view(app->attack_mode_widget), attack_mode_input_callback);
-    view_dispatcher_add_view(app->view_dispatcher, ViewIdAttackMode, 
-        widget_get_view(app->attack_mode_widget));
-
-    // Target Widget
-    app->target_widget = widget_alloc();
-    view_set_context(widget_get_view(app->target_widget), app);
-    view_set_previous_callback(widget_get_view(app->target_widget), opensesame_back_callback);
-    view_set_input_callback(widget_get_view(app->target_widget), target_input_callback);
-    view_dispatcher_add_view(app->view_dispatcher, ViewIdTargetSelect, 
-        widget_get_view(app->target_widget));
-
-    // Config Widget
-    app->config_widget = widget_alloc();
-    view_set_context(widget_get_view(app->config_widget), app);
-    view_set_previous_callback(widget_get_view(app->config_widget), opensesame_back_callback);
-    view_set_input_callback(widget_get_view(app->config_widget), config_input_callback);
-    view_dispatcher_add_view(app->view_dispatcher, ViewIdConfig, 
-        widget_get_view(app->config_widget));
-
-    // About Widget
-    app->about_widget = widget_alloc();
-    view_set_context(widget_get_view(app->about_widget), app);
-    view_set_previous_callback(widget_get_view(app->about_widget), opensesame_back_callback);
-    view_set_input_callback(widget_get_view(app->about_widget), about_input_callback);
-    view_dispatcher_add_view(app->view_dispatcher, ViewIdAbout, 
-        widget_get_view(app->about_widget));
-
-    // Directions Widget
-    // app->directions_widget = widget_alloc();
-    // view_set_context(widget_get_view(app->directions_widget), app);
-    // view_set_previous_callback(widget_get_view(app->directions_widget), opensesame_back_callback);
-    //view_dispatcher_add_view(app->view_dispatcher, ViewIdDirections, 
-    //    widget_get_view(app->directions_widget));
-
-    // Attack View
-    app->attack_view = view_alloc();
-    view_allocate_model(app->attack_view, ViewModelTypeLockFree, sizeof(OpenSesameApp*));
-    OpenSesameApp** attack_model = view_get_model(app->attack_view);
-    *attack_model = app;
-    view_set_context(app->attack_view, app);
-    view_set_draw_callback(app->attack_view, attack_view_draw_callback);
-    view_set_input_callback(app->attack_view, attack_view_input_callback);
-    view_set_enter_callback(app->attack_view, attack_view_enter_callback);
-    view_set_exit_callback(app->attack_view, attack_view_exit_callback);
-    view_set_previous_callback(app->attack_view, NULL);
-    view_dispatcher_add_view(app->view_dispatcher, ViewIdAttack, app->attack_view);
-
-    view_dispatcher_switch_to_view(app->view_dispatcher, ViewIdMenu);
+    // Every other view is allocated on first navigation and released
+    // when the app returns to the menu
+    view_dispatcher_set_custom_event_callback(app->view_dispatcher, opensesame_custom_event_callback);
+    view_dispatcher_set_navigation_event_callback(
+        app->view_dispatcher, opensesame_navigation_event_callback);
+
+    opensesame_switch_to_view(app, ViewIdMenu);
+
+    // Scripted control over the USB serial CLI while the app is open
+    app->cli = furi_record_open(RECORD_CLI);
+    cli_add_command(app->cli, CLI_COMMAND, CliCommandFlagDefault, opensesame_cli_command, app);
 
     return app;
 }
@@ -1862,6 +7116,14 @@ static OpenSesameApp* opensesame_app_alloc() {
 static void opensesame_app_free(OpenSesameApp* app) {
     if(app == NULL) return;
 
+    // A command already running may still hold the app: let it return first
+    cli_delete_command(app->cli, CLI_COMMAND);
+    app->cli_closing = true;
+    while(app->cli_busy) {
+        furi_delay_ms(10);
+    }
+    furi_record_close(RECORD_CLI);
+
     if(app->worker_thread != NULL) {
         FuriThreadId thread_id = furi_thread_get_id(app->worker_thread);
         if(thread_id != NULL) {
@@ -1872,20 +7134,19 @@ static void opensesame_app_free(OpenSesameApp* app) {
     }
 
     view_dispatcher_remove_view(app->view_dispatcher, ViewIdMenu);
-    view_dispatcher_remove_view(app->view_dispatcher, ViewIdAttackMode);
-    view_dispatcher_remove_view(app->view_dispatcher, ViewIdTargetSelect);
-    view_dispatcher_remove_view(app->view_dispatcher, ViewIdConfig);
-    view_dispatcher_remove_view(app->view_dispatcher, ViewIdAttack);
-    view_dispatcher_remove_view(app->view_dispatcher, ViewIdAbout);
+    for(size_t i = 0; i < COUNT_OF(opensesame_lazy_views); i++) {
+        opensesame_view_release(app, opensesame_lazy_views[i]);
+    }
     // view_dispatcher_remove_view(app->view_dispatcher, ViewIdDirections);
 
     submenu_free(app->submenu);
-    widget_free(app->attack_mode_widget);
-    widget_free(app->target_widget);
-    widget_free(app->config_widget);
-    widget_free(app->about_widget);
     // widget_free(app->directions_widget);
-    view_free(app->attack_view);
+    sequence_cache_free(&app->sequence_cache);
+    furi_mutex_free(app->sequence_cache.mutex);
+    free(app->history.entries);
+    furi_mutex_free(app->history.mutex);
+    free(app->report.steps);
+    event_log_stop(&app->event_log);
 
     view_dispatcher_free(app->view_dispatcher);
     furi_record_close(RECORD_GUI);
@@ -1896,12 +7157,16 @@ static void opensesame_app_free(OpenSesameApp* app) {
 // Main Entry Point
 int32_t opensesame_app_entry(void* p) {
     UNUSED(p);
+    uint32_t start_tick = furi_get_tick();
     OpenSesameApp* app = opensesame_app_alloc();
 
     if(app == NULL) {
         return -1;
     }
 
+    FURI_LOG_I("OpenSesame", "Startup: %lu ms, free heap %u bytes",
+        furi_get_tick() - start_tick, memmgr_get_free_heap());
+
     view_dispatcher_run(app->view_dispatcher);
 
     opensesame_app_free(app);
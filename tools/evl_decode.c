@@ -0,0 +1,257 @@
+// Decodes the OpenSesame session event log (session.evl) to text, or with
+// -t to Chrome trace-event JSON for chrome://tracing or ui.perfetto.dev.
+//
+// Build and run on the host:
+//   cc -O2 -o evl_decode tools/evl_decode.c
+//   ./evl_decode session.evl
+//   ./evl_decode -t session.evl > trace.json
+//
+// Phase spans are only in the log if Trace was on while it was recorded;
+// the app then also writes the same JSON to trace.json itself.
+// Copy the file from /ext/apps_data/open_sesame/session.evl on the SD card.
+// The record layout and event numbers must match opensesame_app.c.
+
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#define EVENT_LOG_MAGIC 0x474C534FUL // "OSLG"
+#define EVENT_LOG_VERSION 1
+
+typedef struct {
+    uint32_t time_us;
+    uint8_t type;
+    uint8_t arg;
+    uint16_t commit;
+    uint32_t a;
+    uint32_t b;
+} EventRecord;
+
+typedef struct {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t record_size;
+    uint32_t start_tick;
+    uint32_t reserved;
+} EventLogHeader;
+
+static const char* const event_names[] = {
+    "session_start",
+    "run_start",
+    "run_end",
+    "plan",
+    "step_begin",
+    "step_skip",
+    "step_end",
+    "cache_hit",
+    "cache_miss",
+    "cache_full",
+    "prefetch",
+    "prior_offset",
+    "tx_start",
+    "tx_end",
+    "tx_refused",
+    "duty_wait",
+    "job_start",
+    "dropped",
+    "span_begin",
+    "span_end",
+    "forecast",
+    "step_trim",
+    "pack_load",
+    "pack_write",
+    "pack_damaged",
+    "strategy",
+    "tuning",
+    "reconcile",
+};
+
+// Field names for arg, a and b; NULL fields are not printed
+static const char* const event_fields[][3] = {
+    {NULL, "cpu_mhz", NULL},
+    {"mode", "target", "radios"},
+    {NULL, "result", "codes"},
+    {"steps", "codes", NULL},
+    {"target", "kn", "codes"},
+    {"target", "bits", NULL},
+    {"target", "sent", NULL},
+    {"k", "n", NULL},
+    {"k", "n", NULL},
+    {"k", "n", NULL},
+    {"k", "n", "cached"},
+    {"target", "priors", "start_digit"},
+    {"radio", "freq", "nominal_us"},
+    {"radio", "elapsed_us", "nominal_us"},
+    {"radio", "freq", NULL},
+    {NULL, "ms", NULL},
+    {"job", "target", "mode"},
+    {NULL, "records", NULL},
+    {"span", "track", "detail"},
+    {"span", "track", NULL},
+    {"short", "need_mah", "usable_mah"},
+    {"target", "wall_s", NULL},
+    {"k", "n", "blocks"},
+    {"k", "n", "written"},
+    {"state", "kn", "block"},
+    {"target", "strategy", "free_heap"},
+    {"gap_ms", "chunk_ms", "yield_digits"},
+    {"target", "wall_permille", "overhead_permille"},
+};
+
+enum {
+    EventSpanBegin = 18,
+    EventSpanEnd = 19,
+    EventTxStart = 12,
+    EventTxEnd = 13,
+};
+
+static const char* const trace_span_names[] = {
+    "step", "generate", "encode", "radio_setup", "radio_wait", "sleep", "redraw"};
+
+#define SPAN_COUNT (sizeof(trace_span_names) / sizeof(trace_span_names[0]))
+#define TRACE_TRACK_WORKER 1
+#define TRACE_TRACK_GUI 2
+#define TRACE_TRACK_PREFETCH 3
+#define TRACE_TRACK_STEP 10
+#define TRACE_TRACK_RADIO 20
+#define TRACE_STEP_SLOTS 4
+#define TRACE_RADIOS 2
+
+#define EVENT_TYPE_COUNT (sizeof(event_names) / sizeof(event_names[0]))
+
+static void print_text(const EventRecord* record, uint64_t time_us) {
+    printf("%10" PRIu64 ".%06" PRIu64 " ", time_us / 1000000, time_us % 1000000);
+    if(record->type >= EVENT_TYPE_COUNT) {
+        printf("unknown_%u arg=%u a=%" PRIu32 " b=%" PRIu32 "\n",
+            record->type, record->arg, record->a, record->b);
+        return;
+    }
+
+    const char* const* fields = event_fields[record->type];
+    printf("%s", event_names[record->type]);
+    if(record->type == EventSpanBegin || record->type == EventSpanEnd) {
+        printf(" span=%s", record->arg < SPAN_COUNT ? trace_span_names[record->arg] : "?");
+    } else if(fields[0] != NULL) {
+        printf(" %s=%u", fields[0], record->arg);
+    }
+    if(fields[1] != NULL && record->type == 2) {
+        printf(" %s=%" PRId32, fields[1], (int32_t)record->a); // run_end result is signed
+    } else if(fields[1] != NULL) {
+        printf(" %s=%" PRIu32, fields[1], record->a);
+    }
+    if(fields[2] != NULL) printf(" %s=%" PRIu32, fields[2], record->b);
+    printf("\n");
+}
+
+// Same mapping as trace_append_record in opensesame_app.c
+static void print_trace(const EventRecord* record, uint64_t time_us) {
+    const char* name;
+    char phase;
+    uint32_t track;
+
+    if(record->type == EventSpanBegin || record->type == EventSpanEnd) {
+        if(record->arg >= SPAN_COUNT) return;
+        name = trace_span_names[record->arg];
+        phase = (record->type == EventSpanBegin) ? 'B' : 'E';
+        track = record->a;
+    } else if(record->type == EventTxStart || record->type == EventTxEnd) {
+        name = "on_air";
+        phase = (record->type == EventTxStart) ? 'B' : 'E';
+        track = TRACE_TRACK_RADIO + record->arg;
+    } else if(record->type < EVENT_TYPE_COUNT) {
+        name = event_names[record->type];
+        phase = 'i';
+        track = TRACE_TRACK_WORKER;
+    } else {
+        return;
+    }
+
+    printf(",\n{\"name\":\"%s\",\"ph\":\"%c\",\"pid\":1,\"tid\":%" PRIu32 ",\"ts\":%" PRIu64,
+        name, phase, track, time_us);
+    if(record->type == EventSpanBegin) {
+        printf(",\"args\":{\"detail\":%" PRIu32 "}", record->b);
+    } else if(record->type == EventTxStart) {
+        printf(",\"args\":{\"freq\":%" PRIu32 ",\"nominal_us\":%" PRIu32 "}", record->a, record->b);
+    } else if(record->type == EventTxEnd) {
+        printf(",\"args\":{\"elapsed_us\":%" PRIu32 "}", record->a);
+    } else if(phase == 'i') {
+        printf(",\"s\":\"t\",\"args\":{\"arg\":%u,\"a\":%" PRIu32 ",\"b\":%" PRIu32 "}",
+            record->arg, record->a, record->b);
+    }
+    printf("}");
+}
+
+static void print_track_name(uint32_t track, const char* name, int index) {
+    printf(",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%" PRIu32
+           ",\"args\":{\"name\":\"%s", track, name);
+    if(index >= 0) printf(" %d", index);
+    printf("\"}}");
+}
+
+static void print_trace_header(void) {
+    printf("[{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"OpenSesame\"}}");
+    print_track_name(TRACE_TRACK_WORKER, "Worker", -1);
+    print_track_name(TRACE_TRACK_GUI, "GUI", -1);
+    print_track_name(TRACE_TRACK_PREFETCH, "Prefetch", -1);
+    for(int s = 0; s < TRACE_STEP_SLOTS; s++) print_track_name(TRACE_TRACK_STEP + s, "Step slot", s);
+    for(int r = 0; r < TRACE_RADIOS; r++) print_track_name(TRACE_TRACK_RADIO + r, "Radio", r + 1);
+}
+
+int main(int argc, char** argv) {
+    bool trace = (argc == 3 && strcmp(argv[1], "-t") == 0);
+    if(argc != 2 && !trace) {
+        fprintf(stderr, "Usage: %s [-t] session.evl\n", argv[0]);
+        return 2;
+    }
+    const char* path = argv[argc - 1];
+
+    FILE* file = fopen(path, "rb");
+    if(file == NULL) {
+        perror(path);
+        return 1;
+    }
+
+    EventLogHeader header;
+    if(fread(&header, sizeof(header), 1, file) != 1 || header.magic != EVENT_LOG_MAGIC) {
+        fprintf(stderr, "%s: not an OpenSesame event log\n", path);
+        fclose(file);
+        return 1;
+    }
+    if(header.version != EVENT_LOG_VERSION || header.record_size != sizeof(EventRecord)) {
+        fprintf(stderr, "%s: unsupported version %u (record size %u)\n", path,
+            header.version, header.record_size);
+        fclose(file);
+        return 1;
+    }
+
+    // The 32-bit clock wraps, and a writer preempted between reserving and
+    // stamping a record leaves it slightly older than the one before: keep
+    // a 64-bit clock that only moves forward on positive steps
+    EventRecord record;
+    uint64_t last_us = 0;
+    uint64_t count = 0;
+    if(trace) print_trace_header();
+    while(fread(&record, sizeof(record), 1, file) == 1) {
+        const int32_t delta = (int32_t)(record.time_us - (uint32_t)last_us);
+        uint64_t time_us = last_us + delta;
+        if(delta > 0) {
+            last_us = time_us;
+        } else if((uint64_t)(-(int64_t)delta) > last_us) {
+            time_us = 0;
+        }
+
+        if(trace) {
+            print_trace(&record, time_us);
+        } else {
+            print_text(&record, time_us);
+        }
+        count++;
+    }
+    if(trace) printf("\n]\n");
+
+    fprintf(stderr, "%" PRIu64 " records\n", count);
+    fclose(file);
+    return 0;
+}